@@ -0,0 +1,59 @@
+/*
+ *  VL53L5CX motion-indicator example.  Uses one motion aggregate per column of
+ *  the 4x4 grid, and reports the motion of each column.
+ *
+ *  Copyright (c) 2022 Simon D. Levy
+ *
+ *  MIT License
+ */
+
+#include <Wire.h>
+
+#include "vl53l5cx_arduino.h"
+#include "debugger.hpp"
+
+static const uint8_t LPN_PIN =  14;
+
+// Set to 0 for continuous mode
+static const uint8_t INTEGRAL_TIME_MS = 10;
+
+static VL53L5CX_Arduino _sensor(LPN_PIN, INTEGRAL_TIME_MS, VL53L5CX::RES_4X4_HZ_10);
+
+static VL53L5CX_Motion_Configuration _motionConfig;
+
+void setup(void)
+{
+    Serial.begin(115200);
+
+    Wire.begin();                
+    Wire.setClock(400000);      
+    delay(100);
+
+    _sensor.begin();
+
+    // Watch for movements between 400 and 1500 mm, one aggregate per column
+    vl53l5cx_motion_indicator_config_init(&_motionConfig);
+    vl53l5cx_motion_indicator_config_set_distance(&_motionConfig, 400, 1500);
+    if (vl53l5cx_motion_indicator_config_add_columns(&_motionConfig,
+                VL53L5CX_RESOLUTION_4X4)) {
+        Debugger::reportForever("Invalid motion map");
+    }
+
+    _sensor.setMotionConfig(_motionConfig);
+}
+
+void loop(void)
+{
+    if (_sensor.dataIsReady()) {
+
+        _sensor.readData();
+
+        Debugger::printf("Motion per column:");
+
+        for (uint8_t k=0; k<_motionConfig.nb_of_aggregates; ++k) {
+            Debugger::printf(" %4lu", _sensor.getMotionIndicator(k));
+        }
+
+        Debugger::printf("\n");
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ *  VL53L5CX example sharing frames between consumers through a frame pool:
+ *  a logger prints every frame, and an obstacle detector keeps the frame of
+ *  the closest obstacle seen in the last second, without copying either
+ *
+ *  Copyright (c) 2022 Kris Winer and Simon D. Levy
+ *
+ *  MIT License
+ */
+
+#include <Wire.h>
+
+#include "vl53l5cx_arduino.h"
+#include "debugger.hpp"
+
+static const uint8_t LPN_PIN =  14;
+
+// Set to 0 for continuous mode
+static const uint8_t INTEGRAL_TIME_MS = 10;
+
+static VL53L5CX_Arduino _sensor(LPN_PIN, INTEGRAL_TIME_MS, VL53L5CX::RES_4X4_HZ_10);
+
+// The frame being read, the one kept by the detector, and a spare
+static VL53L5CX_StaticFramePool<3> _pool;
+
+static const VL53L5CX_ResultsData * _closest;
+static int16_t _closestMm;
+static uint32_t _closestMsec;
+
+static int16_t nearest(const VL53L5CX_ResultsData * frame)
+{
+    int16_t nearestMm = INT16_MAX;
+
+    for (auto i=0; i<frame->nb_zones; i++) {
+        if (frame->nb_target_detected[i] > 0 &&
+                frame->distance_mm[i] < nearestMm) {
+            nearestMm = frame->distance_mm[i];
+        }
+    }
+
+    return nearestMm;
+}
+
+static void logFrame(const VL53L5CX_ResultsData * frame)
+{
+    for (auto i=0; i<frame->nb_zones; i++) {
+        Debugger::printf("%4d ", frame->distance_mm[i]);
+    }
+    Debugger::printf("\n");
+}
+
+static void detect(const VL53L5CX_ResultsData * frame)
+{
+    const int16_t nearestMm = nearest(frame);
+
+    if (_closest && millis() - _closestMsec > 1000) {
+        _pool.release(_closest);
+        _closest = NULL;
+    }
+
+    if (!_closest || nearestMm < _closestMm) {
+        if (_closest) {
+            _pool.release(_closest);
+        }
+        _pool.retain(frame);
+        _closest = frame;
+        _closestMm = nearestMm;
+        _closestMsec = millis();
+        Debugger::printf("Closest obstacle : %d mm\n", _closestMm);
+    }
+}
+
+void setup(void)
+{
+    Wire.begin();                
+    Wire.setClock(400000);      
+    delay(100);
+
+    _sensor.begin();
+}
+
+void loop(void)
+{
+    if (_sensor.dataIsReady()) {
+
+        const VL53L5CX_ResultsData * frame = _sensor.readData(_pool);
+
+        if (frame) {
+
+            logFrame(frame);
+
+            detect(frame);
+
+            _pool.release(frame);
+        }
+    } 
+}
@@ -0,0 +1,65 @@
+/*
+ *  VL53L5CX sensing-profile example.  Switches between a long-range 4x4 @ 60 Hz
+ *  profile and a wide 8x8 @ 15 Hz profile, reporting how long each switch
+ *  takes.
+ *
+ *  Copyright (c) 2022 Simon D. Levy
+ *
+ *  MIT License
+ */
+
+#include <Wire.h>
+
+#include "vl53l5cx_arduino.h"
+#include "debugger.hpp"
+
+static const uint8_t LPN_PIN =  14;
+
+// Number of frames to collect between profile switches
+static const uint16_t FRAMES_PER_PROFILE = 100;
+
+static VL53L5CX_Arduino _sensor(LPN_PIN, 0, VL53L5CX::RES_4X4_HZ_60);
+
+static VL53L5CX_Profile _longRange;
+static VL53L5CX_Profile _wide;
+
+static bool _useWide;
+static uint16_t _frameCount;
+
+void setup(void)
+{
+    Serial.begin(115200);
+
+    Wire.begin();                
+    Wire.setClock(400000);      
+    delay(100);
+
+    _sensor.begin();
+
+    // Continuous mode for long range, 10 msec integration for wide
+    _sensor.compileProfile(_longRange, 0, VL53L5CX::RES_4X4_HZ_60);
+    _sensor.compileProfile(_wide, 10, VL53L5CX::RES_8X8_HZ_15);
+}
+
+void loop(void)
+{
+    if (!_sensor.dataIsReady()) {
+        return;
+    }
+
+    const bool switching = _sensor.configIsPending();
+
+    const uint32_t start = micros();
+    _sensor.readData();
+
+    if (switching) {
+        Debugger::printf("Switched to %s profile in %lu usec\n",
+                _useWide ? "wide" : "long-range", micros() - start);
+    }
+
+    if (++_frameCount == FRAMES_PER_PROFILE) {
+        _useWide = !_useWide;
+        _sensor.queueProfile(_useWide ? _wide : _longRange);
+        _frameCount = 0;
+    }
+}
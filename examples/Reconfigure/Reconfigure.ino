@@ -0,0 +1,89 @@
+/*
+ *  VL53L5CX live-reconfiguration benchmark.  Alternates the ranging frequency
+ *  through the queued-config API and reports how many frames are lost each
+ *  time the new setting is applied.
+ *
+ *  Copyright (c) 2022 Simon D. Levy
+ *
+ *  MIT License
+ */
+
+#include <Wire.h>
+
+#include "vl53l5cx_arduino.h"
+#include "debugger.hpp"
+
+static const uint8_t LPN_PIN =  14;
+
+// Set to 0 for continuous mode
+static const uint8_t INTEGRAL_TIME_MS = 10;
+
+// Frequencies we alternate between
+static const uint8_t FREQ_A = 30;
+static const uint8_t FREQ_B = 60;
+
+// Number of frames to collect between reconfigurations
+static const uint16_t FRAMES_PER_RUN = 50;
+
+static VL53L5CX_Arduino _sensor(LPN_PIN, INTEGRAL_TIME_MS, VL53L5CX::RES_4X4_HZ_30);
+
+static uint8_t _frequency = FREQ_A;
+static uint16_t _frameCount;
+static uint32_t _lastFrameUsec;
+static bool _justReconfigured;
+
+static uint32_t _reconfigCount;
+static uint32_t _totalLost;
+
+void setup(void)
+{
+    Serial.begin(115200);
+
+    Wire.begin();                
+    Wire.setClock(400000);      
+    delay(100);
+
+    _sensor.begin();
+}
+
+void loop(void)
+{
+    if (!_sensor.dataIsReady()) {
+        return;
+    }
+
+    const uint32_t usec = micros();
+
+    // readData() applies any queued settings right after reading the frame
+    const bool applying = _sensor.configIsPending();
+    _sensor.readData();
+
+    if (_justReconfigured) {
+
+        // Gap between the last frame at the old rate and the first frame at
+        // the new one, measured in frame periods of the new rate
+        const uint32_t periodUsec = 1000000UL / _frequency;
+        const uint32_t gapUsec = usec - _lastFrameUsec;
+        const uint32_t periods = (gapUsec + periodUsec / 2) / periodUsec;
+        const uint32_t lost = periods > 0 ? periods - 1 : 0;
+
+        _reconfigCount++;
+        _totalLost += lost;
+
+        Debugger::printf("%2d Hz: gap = %6lu usec, lost = %lu, mean lost = ",
+                _frequency, gapUsec, lost);
+        Debugger::printlnfloat((float)_totalLost / _reconfigCount, 2);
+
+    }
+
+    _lastFrameUsec = usec;
+    _justReconfigured = applying;
+
+    if (++_frameCount == FRAMES_PER_RUN) {
+
+        _frequency = _frequency == FREQ_A ? FREQ_B : FREQ_A;
+        _sensor.queueFrequency(_frequency);
+
+        _frameCount = 0;
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ *  VL53L5CX example with resolution, targets and outputs fixed at compile
+ *  time: only distances, target statuses and target counts are streamed
+ *  and stored
+ *
+ *  Copyright (c) 2022 Kris Winer and Simon D. Levy
+ *
+ *  MIT License
+ */
+
+#include <Wire.h>
+
+#include "vl53l5cx_arduino.h"
+#include "vl53l5cx_budget.hpp"
+#include "debugger.hpp"
+
+static const uint8_t LPN_PIN =  14;
+
+// Set to 0 for continuous mode
+static const uint8_t INTEGRAL_TIME_MS = 10;
+
+static const uint8_t FREQUENCY_HZ = 10;
+
+static const uint32_t OUTPUTS =
+    VL53L5CX_OUTPUT_NB_TARGET_DETECTED |
+    VL53L5CX_OUTPUT_DISTANCE_MM |
+    VL53L5CX_OUTPUT_TARGET_STATUS;
+
+static VL53L5CX_StaticArduino<VL53L5CX_RESOLUTION_4X4, 1, OUTPUTS>
+    _sensor(LPN_PIN, INTEGRAL_TIME_MS, FREQUENCY_HZ);
+
+// Driver state, scratch and results must fit in 4 KB
+static_assert(
+        VL53L5CX_Budget<VL53L5CX_RESOLUTION_4X4, 1, OUTPUTS>::ram(1, true)
+        <= 4096, "VL53L5CX uses more than 4 KB of RAM");
+
+void setup(void)
+{
+    Wire.begin();                
+    Wire.setClock(400000);      
+    delay(100);
+
+    _sensor.begin();
+
+    Debugger::printf("%d bytes per frame\n",
+            (int)decltype(_sensor)::Layout::DATA_READ_SIZE);
+}
+
+void loop(void)
+{
+    if (_sensor.dataIsReady() && _sensor.readData()) {
+
+        for (auto i=0; i<_sensor.getPixelCount(); i++) {
+
+            Debugger::printf("Zone : %2d, Nb targets : %2u, ",
+                    i, _sensor.getTargetDetectedCount(i));
+
+            if (_sensor.getTargetDetectedCount(i) > 0) {
+                Debugger::printf("Target status : %3u, Distance : %4d mm\n",
+                        _sensor.getTargetStatus(i), _sensor.getDistanceMm(i));
+            }
+            else {
+                Debugger::printf("Target status : 255, Distance : No target\n");
+            }
+        }
+        Debugger::printf("\n");
+    }
+}
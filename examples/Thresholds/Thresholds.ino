@@ -0,0 +1,90 @@
+/*
+ *  VL53L5CX threshold-interrupt example.  The sensor only raises INT when
+ *  something is within 300 mm of one of the 16 zones, so the host does no
+ *  I^2C traffic at all in between.
+ *
+ *  Copyright (c) 2022 Simon D. Levy
+ *
+ *  MIT License
+ */
+
+#include <Wire.h>
+
+#include "vl53l5cx_arduino.h"
+#include "debugger.hpp"
+
+// Required: this mode has no polling fallback
+static const uint8_t INT_PIN = 4;
+
+static const uint8_t LPN_PIN =  14;
+
+// Set to 0 for continuous mode
+static const uint8_t INTEGRAL_TIME_MS = 10;
+
+static const int32_t DISTANCE_MM = 300;
+
+static VL53L5CX_Arduino _sensor(LPN_PIN, INTEGRAL_TIME_MS, VL53L5CX::RES_4X4_HZ_10);
+
+static VL53L5CX_DetectionThresholds _thresholds[VL53L5CX_NB_THRESHOLDS];
+static VL53L5CX_DetectionThresholdsSet _thresholdsSet;
+
+static volatile bool _gotInterrupt;
+
+static void interruptHandler() 
+{
+    _gotInterrupt = true;
+}
+
+void setup(void)
+{
+    Serial.begin(115200);
+
+    Wire.begin();                
+    Wire.setClock(400000);      
+    delay(100);
+
+    pinMode(INT_PIN, INPUT);
+    attachInterrupt(INT_PIN, interruptHandler, FALLING);
+
+    _sensor.begin();
+
+    // One "closer than" checker per zone, OR-ed together
+    for (uint8_t i=0; i<_sensor.getPixelCount(); ++i) {
+        _thresholds[i].zone_num = i;
+        _thresholds[i].measurement = VL53L5CX_DISTANCE_MM;
+        _thresholds[i].type = VL53L5CX_LESS_THAN_EQUAL_MIN_CHECKER;
+        _thresholds[i].mathematic_operation = VL53L5CX_OPERATION_OR;
+        _thresholds[i].param_low_thresh = DISTANCE_MM;
+        _thresholds[i].param_high_thresh = DISTANCE_MM;
+    }
+    _thresholds[_sensor.getPixelCount()-1].zone_num |= VL53L5CX_LAST_THRESHOLD;
+
+    if (!VL53L5CX::compileThresholds(_thresholdsSet, _thresholds)) {
+        Debugger::reportForever("Invalid thresholds");
+    }
+
+    _sensor.setThresholds(_thresholdsSet);
+}
+
+void loop(void)
+{
+    if (!_gotInterrupt) {
+        return;
+    }
+
+    _gotInterrupt = false;
+
+    _sensor.readData();
+
+    const uint64_t fired = _sensor.getFiredThresholds();
+
+    Debugger::printf("Within %d mm in zones:", DISTANCE_MM);
+
+    for (uint8_t i=0; i<_sensor.getPixelCount(); ++i) {
+        if (fired & ((uint64_t)1 << i)) {
+            Debugger::printf(" %d", i);
+        }
+    }
+
+    Debugger::printf("\n");
+}
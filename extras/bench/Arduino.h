@@ -0,0 +1,31 @@
+/*
+   Minimal Arduino API for building the ST driver on a host
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+void delay(const uint32_t msec);
+
+uint32_t micros(void);
+
+uint32_t millis(void);
+
+class HostSerial {
+
+    public:
+
+        void print(const char * s)
+        {
+            fputs(s, stdout);
+        }
+
+}; // class HostSerial
+
+extern HostSerial Serial;
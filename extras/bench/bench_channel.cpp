@@ -0,0 +1,311 @@
+/*
+   Frames of a 4x4 sensor broadcast to several subscribers through a
+   VL53L5CX_FrameChannel:
+
+   - cost of publishing a frame for 0 to 16 subscriber threads, compared
+     with copying the frame to each subscriber under its own mutex
+
+   - the sensor at 60 Hz with subscribers at different rates: control at
+     60 Hz, telemetry at 5 Hz, recording at 60 Hz taking frames every
+     100 ms, and a recorder stalling for 250 ms at a time, which misses
+     frames
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#include "fake_sensor.h"
+#include "vl53l5cx_frame_channel.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+static const uint8_t SUBSCRIBERS[] = {0, 1, 2, 4, 8, 16};
+
+static const uint8_t MAX_SUBSCRIBERS = 16;
+
+static const uint8_t CAPACITY = 8;
+
+static const uint32_t FRAMES = 20000;
+
+static const uint32_t SCENARIO_MS = 1000;
+static const uint32_t SENSOR_PERIOD_US = 1000000 / 60;
+
+typedef std::chrono::steady_clock Clock;
+
+static VL53L5CX_Configuration dev;
+
+static VL53L5CX_StaticFrameChannel<CAPACITY> channel;
+
+// Every zone carries the frame number, so that a subscriber can tell a torn
+// copy or a frame other than the one it asked for
+static void read(VL53L5CX_ResultsData & frame, const uint32_t number)
+{
+    vl53l5cx_get_ranging_data(&dev, &frame);
+
+    for (uint8_t z=0; z<VL53L5CX_RESOLUTION_4X4; ++z) {
+        frame.distance_mm[z] = (int16_t)number;
+    }
+}
+
+static bool whole(const VL53L5CX_ResultsData & frame, const uint32_t number)
+{
+    for (uint8_t z=0; z<VL53L5CX_RESOLUTION_4X4; ++z) {
+        if (frame.distance_mm[z] != (int16_t)number) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Each subscriber gets its own copy of the frame, under its own mutex
+struct Copy {
+
+    std::mutex mutex;
+    VL53L5CX_ResultsData frame;
+    uint32_t number = 0;
+    uint32_t read = 0;  // number of the last frame read
+};
+
+template <typename P, typename S>
+static double publishNs(const uint8_t subscribers, P publish, S subscribe)
+{
+    std::atomic<bool> stop(false);
+
+    std::vector<std::thread> threads;
+
+    for (uint8_t s=0; s<subscribers; ++s) {
+        threads.push_back(std::thread([&, s]() {
+                    static thread_local VL53L5CX_ResultsData frame;
+                    while (!stop.load(std::memory_order_relaxed)) {
+                        if (!subscribe(s, frame)) {
+                            std::this_thread::yield();
+                        }
+                    }
+                    }));
+    }
+
+    double totalNs = 0;
+
+    for (uint32_t k=0; k<FRAMES; ++k) {
+        const auto before = Clock::now();
+        publish();
+        totalNs += std::chrono::duration<double, std::nano>(
+                Clock::now() - before).count();
+    }
+
+    stop = true;
+
+    for (auto & thread : threads) {
+        thread.join();
+    }
+
+    return totalNs / FRAMES;
+}
+
+static bool publishing(void)
+{
+    bool ok = true;
+
+    printf("Publishing a 4x4 frame, mean ns\n");
+
+    for (const uint8_t subscribers : SUBSCRIBERS) {
+
+        std::atomic<uint32_t> torn(0);
+
+        static VL53L5CX_FrameSubscriber * readers[MAX_SUBSCRIBERS];
+        for (uint8_t s=0; s<subscribers; ++s) {
+            readers[s] = new VL53L5CX_FrameSubscriber(channel);
+        }
+
+        const double channelNs = publishNs(subscribers,
+                [&]() {
+                    read(*channel.claim(), channel.published() + 1);
+                    channel.commit();
+                },
+                [&](const uint8_t s, VL53L5CX_ResultsData & frame) {
+                    uint32_t number = 0;
+                    if (!readers[s]->read(frame, &number)) {
+                        return false;
+                    }
+                    torn += !whole(frame, number);
+                    return true;
+                });
+
+        for (uint8_t s=0; s<subscribers; ++s) {
+            delete readers[s];
+        }
+
+        static Copy copies[MAX_SUBSCRIBERS];
+        static VL53L5CX_ResultsData decoded;
+        uint32_t number = 0;
+
+        const double copiesNs = publishNs(subscribers,
+                [&]() {
+                    read(decoded, ++number);
+                    for (uint8_t s=0; s<subscribers; ++s) {
+                        std::lock_guard<std::mutex> lock(copies[s].mutex);
+                        copies[s].frame = decoded;
+                        copies[s].number = number;
+                    }
+                },
+                [&](const uint8_t s, VL53L5CX_ResultsData & frame) {
+                    std::lock_guard<std::mutex> lock(copies[s].mutex);
+                    if (copies[s].number == copies[s].read) {
+                        return false;
+                    }
+                    frame = copies[s].frame;
+                    copies[s].read = copies[s].number;
+                    torn += !whole(frame, copies[s].number);
+                    return true;
+                });
+
+        printf("%2u subscribers  channel %6.1f ns  copies %6.1f ns  (%.2fx)\n",
+                subscribers, channelNs, copiesNs, copiesNs / channelNs);
+
+        if (torn) {
+            printf("%u torn frames\n", (unsigned)torn);
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+struct Subscription {
+
+    const char * name;
+    uint8_t decimation;
+    VL53L5CX_FrameSubscriber::overflow_t overflow;
+    uint32_t wakeupUs;
+};
+
+static const Subscription SUBSCRIPTIONS[] = {
+    {"control",   1,  VL53L5CX_FrameSubscriber::SKIP_TO_LATEST, 1000},
+    {"telemetry", 12, VL53L5CX_FrameSubscriber::SKIP_TO_LATEST, 200000},
+    {"recording", 1,  VL53L5CX_FrameSubscriber::SKIP_TO_OLDEST, 100000},
+    {"stalled",   1,  VL53L5CX_FrameSubscriber::SKIP_TO_OLDEST, 250000},
+};
+
+static const uint8_t SUBSCRIPTION_COUNT =
+    sizeof(SUBSCRIPTIONS) / sizeof(Subscription);
+
+static bool scenario(void)
+{
+    const uint32_t frames = SCENARIO_MS * 1000 / SENSOR_PERIOD_US;
+
+    std::atomic<bool> stop(false);
+
+    uint32_t received[SUBSCRIPTION_COUNT] = {};
+    uint32_t missed[SUBSCRIPTION_COUNT] = {};
+    uint32_t wrong[SUBSCRIPTION_COUNT] = {};
+
+    std::vector<std::thread> threads;
+
+    const auto start = Clock::now();
+
+    for (uint8_t s=0; s<SUBSCRIPTION_COUNT; ++s) {
+
+        threads.push_back(std::thread([&, s]() {
+
+                    const Subscription & subscription = SUBSCRIPTIONS[s];
+
+                    VL53L5CX_FrameSubscriber subscriber(channel,
+                            subscription.decimation, subscription.overflow);
+
+                    static thread_local VL53L5CX_ResultsData frame;
+
+                    uint32_t expected = channel.published() + 1;
+
+                    for (uint32_t k=1; !stop; ++k) {
+
+                        std::this_thread::sleep_until(start +
+                                std::chrono::microseconds(
+                                    k * subscription.wakeupUs));
+
+                        uint32_t number = 0;
+
+                        while (subscriber.read(frame, &number)) {
+
+                            // Frames follow the decimation, except after
+                            // skipping to the latest frame
+                            const bool onGrid = subscription.overflow ==
+                                VL53L5CX_FrameSubscriber::SKIP_TO_LATEST ||
+                                (number - expected) %
+                                subscription.decimation == 0;
+
+                            wrong[s] += !whole(frame, number) || !onGrid;
+
+                            expected = number;
+                            received[s]++;
+                        }
+                    }
+
+                    missed[s] = subscriber.missed();
+                    }));
+    }
+
+    // Lets the subscribers start with the first frame
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    for (uint32_t k=1; k<=frames; ++k) {
+
+        std::this_thread::sleep_until(
+                start + std::chrono::microseconds(k * SENSOR_PERIOD_US));
+
+        read(*channel.claim(), channel.published() + 1);
+        channel.commit();
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    stop = true;
+
+    for (auto & thread : threads) {
+        thread.join();
+    }
+
+    printf("\n%u frames at 60 Hz, channel of %u frames\n",
+            (unsigned)frames, CAPACITY);
+
+    bool ok = true;
+
+    for (uint8_t s=0; s<SUBSCRIPTION_COUNT; ++s) {
+
+        const Subscription & subscription = SUBSCRIPTIONS[s];
+
+        printf("%-10s  1 of %2u frames  wakes every %6.1f ms  "
+                "%3u received  %3u missed\n",
+                subscription.name, subscription.decimation,
+                subscription.wakeupUs / 1e3,
+                (unsigned)received[s], (unsigned)missed[s]);
+
+        if (wrong[s]) {
+            printf("%u frames torn or off the decimation\n",
+                    (unsigned)wrong[s]);
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+int main(void)
+{
+    fakeSensor.attach(&dev, VL53L5CX_RESOLUTION_4X4);
+
+    if (vl53l5cx_start_ranging(&dev)) {
+        printf("start_ranging failed\n");
+        return 1;
+    }
+
+    fakeSensor.newFrame();
+
+    return publishing() && scenario() ? 0 : 1;
+}
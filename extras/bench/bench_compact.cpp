@@ -0,0 +1,85 @@
+/*
+   Compares decoding a 4x4 frame into VL53L5CX_ResultsData with decoding it
+   into the compact VL53L5CX_Results4x4
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#include "fake_sensor.h"
+
+#include <stdio.h>
+
+static const uint32_t FRAMES = 200000;
+
+static VL53L5CX_ResultsData results;
+static VL53L5CX_Results4x4 compact;
+
+static bool agree(void)
+{
+    for (uint8_t z=0; z<VL53L5CX_RESOLUTION_4X4; ++z) {
+
+        const uint32_t ambient = results.ambient_per_spad[z] > 0xFFFF ?
+            0xFFFF : results.ambient_per_spad[z];
+        const uint32_t signal = results.signal_per_spad[z] > 0xFFFF ?
+            0xFFFF : results.signal_per_spad[z];
+
+        if (compact.nb_target_detected[z] != results.nb_target_detected[z] ||
+                compact.nb_spads_enabled[z] != results.nb_spads_enabled[z] ||
+                compact.ambient_per_spad[z] != ambient ||
+                compact.signal_per_spad[z] != signal ||
+                compact.range_sigma_mm[z] != results.range_sigma_mm[z] ||
+                compact.distance_mm[z] != results.distance_mm[z] ||
+                compact.reflectance[z] != results.reflectance[z] ||
+                compact.target_status[z] != results.target_status[z]) {
+            printf("zone %u: layouts disagree\n", z);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(void)
+{
+    static VL53L5CX_Configuration dev;
+
+    fakeSensor.attach(&dev, VL53L5CX_RESOLUTION_8X8);
+    vl53l5cx_start_ranging(&dev);
+    if (vl53l5cx_get_ranging_data_4x4(&dev, &compact) !=
+            VL53L5CX_STATUS_INVALID_PARAM) {
+        printf("8x8 frame was decoded into 4x4 results\n");
+        return 1;
+    }
+
+    fakeSensor.attach(&dev, VL53L5CX_RESOLUTION_4X4);
+
+    if (vl53l5cx_start_ranging(&dev)) {
+        printf("start_ranging failed\n");
+        return 1;
+    }
+
+    for (uint8_t k=0; k<10; ++k) {
+        fakeSensor.newFrame();
+        vl53l5cx_get_ranging_data(&dev, &results);
+        if (vl53l5cx_get_ranging_data_4x4(&dev, &compact) ||
+                !agree()) {
+            return 1;
+        }
+    }
+
+    const double resultsNs = measure(FRAMES, [&](const uint32_t) {
+            vl53l5cx_get_ranging_data(&dev, &results);
+            });
+    const double compactNs = measure(FRAMES, [&](const uint32_t) {
+            vl53l5cx_get_ranging_data_4x4(&dev, &compact);
+            });
+
+    printf("4x4  results %4u bytes %6.1f ns  compact %4u bytes %6.1f ns  "
+            "(%.2fx)\n",
+            (unsigned)sizeof(results), resultsNs,
+            (unsigned)sizeof(compact), compactNs, resultsNs / compactNs);
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+/*
+   Compares the fused decoder driven by the plan computed by
+   vl53l5cx_start_ranging() with the legacy decoder, which swaps the whole
+   frame and walks every block header
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#include "fake_sensor.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const uint32_t FRAMES = 200000;
+
+static double decode(VL53L5CX_Configuration * p_dev,
+        VL53L5CX_ResultsData * p_results, const bool walk)
+{
+    const uint8_t planSize = p_dev->decode_plan_size;
+
+    if (walk) {
+        p_dev->decode_plan_size = 0;
+    }
+
+    const double ns = measure(FRAMES, [&](const uint32_t) {
+            vl53l5cx_get_ranging_data(p_dev, p_results);
+            });
+
+    p_dev->decode_plan_size = planSize;
+
+    return ns;
+}
+
+// Lazy decoding of the two fields most sketches use
+static double decodeLazy(VL53L5CX_Configuration * p_dev,
+        VL53L5CX_ResultsData * p_results)
+{
+    return measure(FRAMES, [&](const uint32_t) {
+            vl53l5cx_get_raw_data(p_dev, p_results);
+            vl53l5cx_decode_field(p_dev, p_results,
+                    VL53L5CX_OUTPUT_DISTANCE_MM);
+            vl53l5cx_decode_field(p_dev, p_results,
+                    VL53L5CX_OUTPUT_TARGET_STATUS);
+            });
+}
+
+static bool run(const uint8_t resolution, const uint32_t outputs)
+{
+    static VL53L5CX_Configuration dev;
+    static VL53L5CX_ResultsData planned, walked;
+
+    fakeSensor.attach(&dev, resolution);
+    vl53l5cx_set_outputs(&dev, outputs);
+
+    if (vl53l5cx_start_ranging(&dev)) {
+        printf("start_ranging failed\n");
+        return false;
+    }
+
+    fakeSensor.newFrame();
+
+    // Both decoders must agree on the same frame
+    memset(&planned, 0, sizeof(planned));
+    memset(&walked, 0, sizeof(walked));
+    decode(&dev, &planned, false);
+    decode(&dev, &walked, true);
+
+    if (memcmp(&planned, &walked, sizeof(planned))) {
+        printf("%dx%d: decoders disagree\n", resolution == 16 ? 4 : 8,
+                resolution == 16 ? 4 : 8);
+        return false;
+    }
+
+    const double walkNs = decode(&dev, &walked, true);
+    const double planNs = decode(&dev, &planned, false);
+    const double lazyNs = decodeLazy(&dev, &planned);
+
+    printf("%dx%d  %4u bytes  %2u steps  walk %7.1f ns  plan %7.1f ns  "
+            "(%.2fx)  lazy distance+status %7.1f ns\n",
+            resolution == 16 ? 4 : 8, resolution == 16 ? 4 : 8,
+            (unsigned)dev.data_read_size, dev.decode_plan_size,
+            walkNs, planNs, walkNs / planNs, lazyNs);
+
+    return true;
+}
+
+int main(void)
+{
+    const uint32_t altitude =
+        VL53L5CX_OUTPUT_DISTANCE_MM | VL53L5CX_OUTPUT_TARGET_STATUS;
+
+    return
+        run(VL53L5CX_RESOLUTION_4X4, VL53L5CX_OUTPUT_ALL) &&
+        run(VL53L5CX_RESOLUTION_8X8, VL53L5CX_OUTPUT_ALL) &&
+        run(VL53L5CX_RESOLUTION_4X4, altitude) &&
+        run(VL53L5CX_RESOLUTION_8X8, altitude) ? 0 : 1;
+}
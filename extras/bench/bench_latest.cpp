@@ -0,0 +1,207 @@
+/*
+   Compares readers copying the latest frame out of a VL53L5CX_LatestFrame
+   with the same readers copying it under a mutex, for 1 to 16 reader
+   threads.  The writer publishes a frame every millisecond, well above the
+   sensor's rate, stamping each frame so that readers can tell a torn copy;
+   the readers copy frames as fast as they can.
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#include "fake_sensor.h"
+#include "vl53l5cx_latest_frame.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+static const uint32_t DURATION_MS = 200;
+
+static const uint32_t PERIOD_US = 1000;
+
+static const uint8_t READERS[] = {1, 2, 4, 8, 16};
+
+typedef std::chrono::steady_clock Clock;
+
+struct Stats {
+
+    double readsPerSecond;
+    double meanPublishNs;
+    double maxPublishNs;
+    uint64_t reads;
+    uint64_t failed;
+    uint64_t torn;
+};
+
+// Every zone carries the frame number, so that a copy mixing two frames
+// can be told
+static void stamp(VL53L5CX_ResultsData & frame, const uint32_t k)
+{
+    for (uint8_t z=0; z<VL53L5CX_RESOLUTION_8X8; ++z) {
+        frame.distance_mm[z] = (int16_t)k;
+        frame.signal_per_spad[z] = k;
+    }
+}
+
+static bool whole(const VL53L5CX_ResultsData & frame)
+{
+    for (uint8_t z=0; z<VL53L5CX_RESOLUTION_8X8; ++z) {
+        if (frame.signal_per_spad[z] != frame.signal_per_spad[0] ||
+                frame.distance_mm[z] != (int16_t)frame.signal_per_spad[0]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// publish(frame) publishes a frame; read(frame) returns false if it could
+// not copy one
+template <typename P, typename R>
+static Stats run(
+        const VL53L5CX_ResultsData & first,
+        const uint8_t readers,
+        P publish,
+        R read)
+{
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> reads(0), failed(0), torn(0);
+
+    publish(first);
+
+    std::vector<std::thread> threads;
+
+    for (uint8_t r=0; r<readers; ++r) {
+        threads.push_back(std::thread([&]() {
+                    static thread_local VL53L5CX_ResultsData frame;
+                    uint64_t n = 0, f = 0, t = 0;
+                    while (!stop.load(std::memory_order_relaxed)) {
+                        if (read(frame)) {
+                            n++;
+                            t += !whole(frame);
+                        }
+                        else {
+                            f++;
+                        }
+                    }
+                    reads += n;
+                    failed += f;
+                    torn += t;
+                    }));
+    }
+
+    VL53L5CX_ResultsData frame = first;
+
+    const uint32_t frames = DURATION_MS * 1000 / PERIOD_US;
+
+    double totalNs = 0, maxNs = 0;
+
+    const auto start = Clock::now();
+
+    for (uint32_t k=1; k<=frames; ++k) {
+
+        std::this_thread::sleep_until(
+                start + std::chrono::microseconds(k * PERIOD_US));
+
+        stamp(frame, k);
+
+        const auto before = Clock::now();
+        publish(frame);
+        const double ns = std::chrono::duration<double, std::nano>(
+                Clock::now() - before).count();
+
+        totalNs += ns;
+        maxNs = ns > maxNs ? ns : maxNs;
+    }
+
+    const double seconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+
+    stop = true;
+
+    for (auto & thread : threads) {
+        thread.join();
+    }
+
+    Stats stats;
+    stats.readsPerSecond = reads / seconds;
+    stats.meanPublishNs = totalNs / frames;
+    stats.maxPublishNs = maxNs;
+    stats.reads = reads;
+    stats.failed = failed;
+    stats.torn = torn;
+
+    return stats;
+}
+
+int main(void)
+{
+    static VL53L5CX_Configuration dev;
+    static VL53L5CX_ResultsData first;
+
+    fakeSensor.attach(&dev, VL53L5CX_RESOLUTION_8X8);
+
+    if (vl53l5cx_start_ranging(&dev)) {
+        printf("start_ranging failed\n");
+        return 1;
+    }
+
+    fakeSensor.newFrame();
+    vl53l5cx_get_ranging_data(&dev, &first);
+    stamp(first, 0);
+
+    printf("%u hardware threads, %u ms per run; publish = mean / max ns\n\n",
+            std::thread::hardware_concurrency(), (unsigned)DURATION_MS);
+    printf("readers  %-45s  %s\n", "seqlock", "mutex");
+
+    bool ok = true;
+
+    for (const uint8_t readers : READERS) {
+
+        static VL53L5CX_LatestFrame latest;
+
+        const Stats seqlock = run(first, readers,
+                [&](const VL53L5CX_ResultsData & frame) {
+                    latest.publish(frame);
+                },
+                [&](VL53L5CX_ResultsData & frame) {
+                    return latest.tryRead(frame);
+                });
+
+        static std::mutex mutex;
+        static VL53L5CX_ResultsData shared;
+
+        const Stats locked = run(first, readers,
+                [&](const VL53L5CX_ResultsData & frame) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    shared = frame;
+                },
+                [&](VL53L5CX_ResultsData & frame) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    frame = shared;
+                    return true;
+                });
+
+        printf("%7u  %5.2f M reads/s %5.0f / %8.0f ns %5.1f%% retried"
+                "  %5.2f M reads/s %5.0f / %8.0f ns\n",
+                readers,
+                seqlock.readsPerSecond / 1e6,
+                seqlock.meanPublishNs, seqlock.maxPublishNs,
+                100. * seqlock.failed / (seqlock.failed + seqlock.reads),
+                locked.readsPerSecond / 1e6,
+                locked.meanPublishNs, locked.maxPublishNs);
+
+        if (seqlock.torn || locked.torn) {
+            printf("%u and %u torn frames\n",
+                    (unsigned)seqlock.torn, (unsigned)locked.torn);
+            ok = false;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
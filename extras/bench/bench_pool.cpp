@@ -0,0 +1,111 @@
+/*
+   Compares three consumers each copying VL53L5CX_ResultsData out of the
+   sensor with the same consumers sharing frames of a VL53L5CX_FramePool
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#include "fake_sensor.h"
+#include "vl53l5cx_frame_pool.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+static const uint32_t FRAMES = 200000;
+
+static const uint8_t CONSUMERS = 3;
+
+// Consumers keep a frame for this many frames before letting it go
+static const uint8_t HOLD[CONSUMERS] = {1, 2, 4};
+
+static const uint8_t POOL_CAPACITY = 4;
+
+// Keeps the consumers' reads from being optimized away
+static volatile int32_t sink;
+
+static bool run(const uint8_t resolution)
+{
+    static VL53L5CX_Configuration dev;
+    static VL53L5CX_ResultsData results;
+    static VL53L5CX_ResultsData copies[CONSUMERS];
+    static VL53L5CX_StaticFramePool<POOL_CAPACITY> pool;
+
+    // Frame held by each consumer, and when it lets it go
+    const VL53L5CX_ResultsData * held[CONSUMERS] = {};
+    uint32_t until[CONSUMERS] = {};
+
+    fakeSensor.attach(&dev, resolution);
+
+    if (vl53l5cx_start_ranging(&dev)) {
+        printf("start_ranging failed\n");
+        return false;
+    }
+
+    fakeSensor.newFrame();
+
+    uint32_t dropped = 0;
+
+    const double copyNs = measure(FRAMES, [&](const uint32_t) {
+            vl53l5cx_get_ranging_data(&dev, &results);
+            for (uint8_t c=0; c<CONSUMERS; ++c) {
+                memcpy(&copies[c], &results, sizeof(results));
+                sink = sink + copies[c].distance_mm[c];
+            }
+            });
+
+    const double poolNs = measure(FRAMES, [&](const uint32_t k) {
+
+            for (uint8_t c=0; c<CONSUMERS; ++c) {
+                if (held[c] && k >= until[c]) {
+                    pool.release(held[c]);
+                    held[c] = NULL;
+                }
+            }
+
+            VL53L5CX_ResultsData * frame = pool.acquire();
+            if (!frame) {
+                dropped++;
+                return;
+            }
+
+            vl53l5cx_get_ranging_data(&dev, frame);
+
+            for (uint8_t c=0; c<CONSUMERS; ++c) {
+                if (!held[c]) {
+                    pool.retain(frame);
+                    held[c] = frame;
+                    until[c] = k + HOLD[c];
+                }
+                sink = sink + held[c]->distance_mm[c];
+            }
+
+            pool.release(frame);
+            });
+
+    for (uint8_t c=0; c<CONSUMERS; ++c) {
+        if (held[c]) {
+            pool.release(held[c]);
+        }
+    }
+
+    if (dropped || pool.available() != pool.capacity()) {
+        printf("%u frames dropped, %u of %u frames still held\n",
+                (unsigned)dropped,
+                (unsigned)(pool.capacity() - pool.available()),
+                (unsigned)pool.capacity());
+        return false;
+    }
+
+    printf("%dx%d  %u consumers  copies %6.1f ns  pool %6.1f ns  (%.2fx)\n",
+            resolution == 16 ? 4 : 8, resolution == 16 ? 4 : 8,
+            (unsigned)CONSUMERS, copyNs, poolNs, copyNs / poolNs);
+
+    return true;
+}
+
+int main(void)
+{
+    return run(VL53L5CX_RESOLUTION_4X4) && run(VL53L5CX_RESOLUTION_8X8) ? 0 : 1;
+}
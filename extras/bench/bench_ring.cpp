@@ -0,0 +1,298 @@
+/*
+   Frames of N sensors at 4x4 handed from an acquisition thread to a
+   processing thread, through one VL53L5CX_FrameRing per sensor:
+
+   - throughput, as fast as both threads can go, compared with a queue
+     copying frames in and out under a mutex
+
+   - latency, from the frame being committed to it being dequeued, with the
+     sensors at 60 Hz and processing waking up at 20 Hz to take every frame
+     accumulated since
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#include "fake_sensor.h"
+#include "vl53l5cx_frame_ring.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+
+static const uint8_t SENSORS[] = {1, 2, 4, 8};
+
+static const uint8_t MAX_SENSORS = 8;
+
+static const uint8_t CAPACITY = 8;
+
+static const uint32_t THROUGHPUT_FRAMES = 50000;
+
+static const uint32_t LATENCY_MS = 500;
+static const uint32_t SENSOR_PERIOD_US = 1000000 / 60;
+static const uint32_t PROCESSING_PERIOD_US = 1000000 / 20;
+
+typedef std::chrono::steady_clock Clock;
+
+static VL53L5CX_Configuration dev;
+
+static VL53L5CX_StaticFrameRing<CAPACITY> rings[MAX_SENSORS];
+
+// Frames carry their number in their first zone, so that the consumer can
+// tell a frame lost or out of order
+static void read(VL53L5CX_ResultsData & frame, const uint32_t k)
+{
+    vl53l5cx_get_ranging_data(&dev, &frame);
+    frame.distance_mm[0] = (int16_t)k;
+}
+
+static bool expected(const VL53L5CX_ResultsData & frame, uint32_t & k)
+{
+    return frame.distance_mm[0] == (int16_t)k++;
+}
+
+// Copies frames in and out under a mutex, one at a time
+class LockedQueue {
+
+    public:
+
+        bool push(const VL53L5CX_ResultsData & frame)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (m_head - m_tail == CAPACITY) {
+                return false;
+            }
+
+            m_frames[m_head++ % CAPACITY] = frame;
+
+            return true;
+        }
+
+        bool pop(VL53L5CX_ResultsData & frame)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (m_head == m_tail) {
+                return false;
+            }
+
+            frame = m_frames[m_tail++ % CAPACITY];
+
+            return true;
+        }
+
+    private:
+
+        std::mutex m_mutex;
+        VL53L5CX_ResultsData m_frames[CAPACITY];
+        uint32_t m_head = 0;
+        uint32_t m_tail = 0;
+};
+
+static double seconds(const Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static bool throughput(const uint8_t sensors)
+{
+    bool ok = true;
+
+    auto start = Clock::now();
+
+    std::thread producer([&]() {
+            for (uint32_t k=0; k<THROUGHPUT_FRAMES; ++k) {
+                for (uint8_t s=0; s<sensors; ++s) {
+                    VL53L5CX_ResultsData * frame;
+                    while ((frame = rings[s].claim()) == NULL) {
+                        std::this_thread::yield();
+                    }
+                    read(*frame, k);
+                    rings[s].commit();
+                }
+            }
+            });
+
+    uint32_t received[MAX_SENSORS] = {};
+
+    for (uint32_t total=0; total<THROUGHPUT_FRAMES * sensors; ) {
+        const uint32_t before = total;
+        for (uint8_t s=0; s<sensors; ++s) {
+            const VL53L5CX_FrameBatch batch = rings[s].dequeue();
+            for (uint8_t i=0; i<batch.size(); ++i) {
+                ok = expected(batch[i], received[s]) && ok;
+            }
+            total += batch.size();
+        }
+        if (total == before) {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+
+    for (uint8_t s=0; s<sensors; ++s) {
+        rings[s].release();
+    }
+
+    const double ringFps = THROUGHPUT_FRAMES * sensors / seconds(start);
+
+    static LockedQueue queues[MAX_SENSORS];
+
+    start = Clock::now();
+
+    std::thread locker([&]() {
+            static VL53L5CX_ResultsData frame;
+            for (uint32_t k=0; k<THROUGHPUT_FRAMES; ++k) {
+                for (uint8_t s=0; s<sensors; ++s) {
+                    read(frame, k);
+                    while (!queues[s].push(frame)) {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+            });
+
+    static VL53L5CX_ResultsData frame;
+
+    uint32_t popped[MAX_SENSORS] = {};
+
+    for (uint32_t total=0; total<THROUGHPUT_FRAMES * sensors; ) {
+        const uint32_t before = total;
+        for (uint8_t s=0; s<sensors; ++s) {
+            while (queues[s].pop(frame)) {
+                ok = expected(frame, popped[s]) && ok;
+                total++;
+            }
+        }
+        if (total == before) {
+            std::this_thread::yield();
+        }
+    }
+
+    locker.join();
+
+    const double lockedFps = THROUGHPUT_FRAMES * sensors / seconds(start);
+
+    printf("%u sensors  ring %6.2f M frames/s  locked queue %6.2f M frames/s"
+            "  (%.2fx)\n",
+            sensors, ringFps / 1e6, lockedFps / 1e6, ringFps / lockedFps);
+
+    if (!ok) {
+        printf("frames lost or out of order\n");
+    }
+
+    return ok;
+}
+
+static bool latency(const uint8_t sensors)
+{
+    // When each frame was committed, by sensor and slot of the ring
+    static Clock::time_point committed[MAX_SENSORS][CAPACITY];
+
+    const uint32_t frames = LATENCY_MS * 1000 / SENSOR_PERIOD_US;
+
+    uint32_t dropped[MAX_SENSORS] = {};
+    for (uint8_t s=0; s<sensors; ++s) {
+        dropped[s] = rings[s].dropped();
+    }
+
+    const auto start = Clock::now();
+
+    std::thread producer([&]() {
+            uint32_t commits[MAX_SENSORS] = {};
+            for (uint32_t k=0; k<frames; ++k) {
+                std::this_thread::sleep_until(
+                        start + std::chrono::microseconds(k * SENSOR_PERIOD_US));
+                for (uint8_t s=0; s<sensors; ++s) {
+                    VL53L5CX_ResultsData * frame = rings[s].claim();
+                    if (frame) {
+                        read(*frame, commits[s]);
+                        committed[s][commits[s]++ % CAPACITY] = Clock::now();
+                        rings[s].commit();
+                    }
+                }
+            }
+            });
+
+    uint32_t received[MAX_SENSORS] = {};
+    uint32_t batches = 0, total = 0;
+    double totalUs = 0, maxUs = 0;
+    bool ok = true;
+
+    // One more wake-up than needed, for the last frames
+    const uint32_t wakeups = LATENCY_MS * 1000 / PROCESSING_PERIOD_US + 1;
+
+    for (uint32_t k=1; k<=wakeups; ++k) {
+
+        std::this_thread::sleep_until(
+                start + std::chrono::microseconds(k * PROCESSING_PERIOD_US));
+
+        for (uint8_t s=0; s<sensors; ++s) {
+
+            const VL53L5CX_FrameBatch batch = rings[s].dequeue();
+            const auto now = Clock::now();
+
+            for (uint8_t i=0; i<batch.size(); ++i) {
+                const double us = std::chrono::duration<double, std::micro>(
+                        now - committed[s][received[s] % CAPACITY]).count();
+                totalUs += us;
+                maxUs = us > maxUs ? us : maxUs;
+                ok = expected(batch[i], received[s]) && ok;
+            }
+
+            batches += batch.size() > 0;
+            total += batch.size();
+        }
+    }
+
+    producer.join();
+
+    uint32_t lost = 0;
+    for (uint8_t s=0; s<sensors; ++s) {
+        rings[s].release();
+        lost += rings[s].dropped() - dropped[s];
+    }
+
+    printf("%u sensors  %4u frames in %3u batches  latency %6.0f / %6.0f us"
+            "  %u dropped\n",
+            sensors, (unsigned)total, (unsigned)batches, totalUs / total, maxUs,
+            (unsigned)lost);
+
+    ok = ok && !lost && total == frames * sensors;
+
+    if (!ok) {
+        printf("frames lost or out of order\n");
+    }
+
+    return ok;
+}
+
+int main(void)
+{
+    fakeSensor.attach(&dev, VL53L5CX_RESOLUTION_4X4);
+
+    if (vl53l5cx_start_ranging(&dev)) {
+        printf("start_ranging failed\n");
+        return 1;
+    }
+
+    fakeSensor.newFrame();
+
+    bool ok = true;
+
+    printf("Throughput, 4x4, ring of %u frames per sensor\n", CAPACITY);
+    for (const uint8_t sensors : SENSORS) {
+        ok = throughput(sensors) && ok;
+    }
+
+    printf("\nLatency, 4x4 at 60 Hz, processing at 20 Hz: mean / max\n");
+    for (const uint8_t sensors : SENSORS) {
+        ok = latency(sensors) && ok;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+/*
+   Compares decoding into VL53L5CX_ResultsData with decoding into results
+   sized at compile time (VL53L5CX_StaticResults)
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#include "fake_sensor.h"
+#include "vl53l5cx_static_results.hpp"
+
+#include <stdio.h>
+
+static const uint32_t FRAMES = 200000;
+
+static const uint32_t RANGING =
+    VL53L5CX_OUTPUT_NB_TARGET_DETECTED |
+    VL53L5CX_OUTPUT_DISTANCE_MM |
+    VL53L5CX_OUTPUT_TARGET_STATUS;
+
+template <uint8_t RESOLUTION, uint32_t OUTPUTS>
+static bool run(void)
+{
+    typedef VL53L5CX_StaticResults<RESOLUTION, 1, OUTPUTS> Results;
+
+    static VL53L5CX_Configuration dev;
+    static VL53L5CX_ResultsData results;
+    static Results fixed;
+
+    fakeSensor.attach(&dev, RESOLUTION);
+    vl53l5cx_set_outputs(&dev, OUTPUTS);
+
+    if (vl53l5cx_start_ranging(&dev)) {
+        printf("start_ranging failed\n");
+        return false;
+    }
+
+    if (dev.data_read_size != Results::Layout::DATA_READ_SIZE) {
+        printf("frame is %u bytes, layout expects %u\n",
+                (unsigned)dev.data_read_size,
+                (unsigned)Results::Layout::DATA_READ_SIZE);
+        return false;
+    }
+
+    fakeSensor.newFrame();
+
+    vl53l5cx_get_ranging_data(&dev, &results);
+    vl53l5cx_get_raw_data(&dev, NULL);
+    if (!fixed.decode(dev.temp_buffer)) {
+        printf("decode failed\n");
+        return false;
+    }
+
+    for (uint8_t z=0; z<fixed.getPixelCount(); ++z) {
+        if (fixed.getDistanceMm(z) != results.distance_mm[z] ||
+                fixed.getTargetStatus(z) != results.target_status[z] ||
+                fixed.getTargetDetectedCount(z) !=
+                results.nb_target_detected[z]) {
+            printf("decoders disagree at zone %d\n", z);
+            return false;
+        }
+    }
+
+    const double generic = measure(FRAMES, [&](const uint32_t) {
+            vl53l5cx_get_ranging_data(&dev, &results);
+            });
+
+    const double sized = measure(FRAMES, [&](const uint32_t) {
+            vl53l5cx_get_raw_data(&dev, NULL);
+            fixed.decode(dev.temp_buffer);
+            });
+
+    printf("%dx%d  %4u bytes  results %5u bytes  %6.1f ns  "
+            "static %5u bytes  %6.1f ns  (%.2fx)\n",
+            RESOLUTION == 16 ? 4 : 8, RESOLUTION == 16 ? 4 : 8,
+            (unsigned)dev.data_read_size,
+            (unsigned)sizeof(results), generic,
+            (unsigned)sizeof(fixed), sized, generic / sized);
+
+    return true;
+}
+
+int main(void)
+{
+    return
+        run<16, VL53L5CX_OUTPUT_ALL>() &&
+        run<64, VL53L5CX_OUTPUT_ALL>() &&
+        run<16, RANGING>() &&
+        run<64, RANGING>() ?
+        0 : 1;
+}
@@ -0,0 +1,103 @@
+/*
+   Compares vl53l5cx_swap_buffer() with the original word-by-word byte swap, on
+   the frame sizes of the 4x4 and 8x8 resolutions.  Build with -mssse3, -mavx2
+   (make simd) or for an ARM target to exercise the vectorized kernels.
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#include "fake_sensor.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+static const uint32_t ROUNDS = 1000000;
+
+static void referenceSwap(uint8_t * buffer, uint16_t size)
+{
+    for(uint32_t i = 0; i < size; i = i + 4) {
+
+        uint32_t tmp = (
+                buffer[i]<<24)
+            |(buffer[i+1]<<16)
+            |(buffer[i+2]<<8)
+            |(buffer[i+3]);
+
+        memcpy(&(buffer[i]), &tmp, 4);
+    }
+}
+
+static const char * kernel(void)
+{
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSSE3__)
+    return "ssse3";
+#elif defined(__ARM_NEON)
+    return "neon";
+#else
+    return "bswap";
+#endif
+}
+
+template <typename F>
+static double measure(F swap, uint8_t * buffer, const uint16_t size)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t k=0; k<ROUNDS; ++k) {
+        swap(buffer, size);
+        // Keep the compiler from merging rounds
+        __asm__ __volatile__("" : : "r"(buffer) : "memory");
+    }
+
+    const auto stop = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(stop - start).count() /
+        ROUNDS;
+}
+
+static bool run(const uint8_t resolution)
+{
+    static VL53L5CX_Configuration dev;
+    static uint8_t expected[VL53L5CX_TEMPORARY_BUFFER_SIZE];
+    static uint8_t actual[VL53L5CX_TEMPORARY_BUFFER_SIZE];
+
+    fakeSensor.attach(&dev, resolution);
+
+    if (vl53l5cx_start_ranging(&dev)) {
+        printf("start_ranging failed\n");
+        return false;
+    }
+
+    const uint16_t size = (uint16_t)dev.data_read_size;
+
+    for (uint16_t k=0; k<size; ++k) {
+        expected[k] = (uint8_t)(k * 7 + 3);
+    }
+    memcpy(actual, expected, size);
+
+    referenceSwap(expected, size);
+    vl53l5cx_swap_buffer(actual, size);
+    if (memcmp(expected, actual, size)) {
+        printf("%u bytes: kernels disagree\n", size);
+        return false;
+    }
+
+    const double referenceNs = measure(referenceSwap, expected, size);
+    const double kernelNs = measure(vl53l5cx_swap_buffer, actual, size);
+
+    printf("%dx%d  %4u bytes  reference %6.1f ns  %-6s %6.1f ns  (%.2fx)\n",
+            resolution == 16 ? 4 : 8, resolution == 16 ? 4 : 8, size,
+            referenceNs, kernel(), kernelNs, referenceNs / kernelNs);
+
+    return true;
+}
+
+int main(void)
+{
+    return run(VL53L5CX_RESOLUTION_4X4) && run(VL53L5CX_RESOLUTION_8X8) ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+/*
+   Compares decoding into VL53L5CX_ResultsData and converting distances and
+   rates to meters and kcps afterwards, with decoding straight into the float
+   and Q16.16 layouts
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#include "fake_sensor.h"
+
+#include <math.h>
+#include <stdio.h>
+
+static const uint32_t FRAMES = 200000;
+
+static VL53L5CX_ResultsData results;
+static VL53L5CX_ResultsFloat floats;
+static VL53L5CX_ResultsFixed fixed;
+
+// What consumers used to do after readData()
+static void convert(VL53L5CX_ResultsFloat & out)
+{
+    const uint16_t n = results.nb_zones * results.nb_target_per_zone;
+
+    for (uint16_t i=0; i<n; ++i) {
+        out.distance_m[i] = results.distance_mm[i] / 1000.f;
+        out.range_sigma_m[i] = results.range_sigma_mm[i] / 1000.f;
+        out.signal_kcps[i] = (float)results.signal_per_spad[i];
+    }
+}
+
+static bool run(const uint8_t resolution)
+{
+    static VL53L5CX_Configuration dev;
+    static VL53L5CX_ResultsFloat converted;
+
+    fakeSensor.attach(&dev, resolution);
+
+    if (vl53l5cx_start_ranging(&dev)) {
+        printf("start_ranging failed\n");
+        return false;
+    }
+
+    fakeSensor.newFrame();
+
+    // All layouts must agree on the same frame (integer results truncate)
+    vl53l5cx_get_ranging_data(&dev, &results);
+    vl53l5cx_get_ranging_data_float(&dev, &floats);
+    vl53l5cx_get_ranging_data_fixed(&dev, &fixed);
+    for (uint8_t z=0; z<results.nb_zones; ++z) {
+        const float mm = floats.distance_m[z] * 1000;
+        const float q16 = fixed.distance_m_q16[z] / 65.536f;
+        if (fabsf(mm - results.distance_mm[z]) >= 1 ||
+                fabsf(q16 - mm) > 0.1f ||
+                floats.target_status[z] != results.target_status[z] ||
+                (uint32_t)floats.signal_kcps[z] != results.signal_per_spad[z]) {
+            printf("zone %u: layouts disagree\n", z);
+            return false;
+        }
+    }
+
+    const double resultsNs = measure(FRAMES, [&](const uint32_t) {
+            vl53l5cx_get_ranging_data(&dev, &results);
+            convert(converted);
+            });
+    const double floatNs = measure(FRAMES, [&](const uint32_t) {
+            vl53l5cx_get_ranging_data_float(&dev, &floats);
+            });
+    const double fixedNs = measure(FRAMES, [&](const uint32_t) {
+            vl53l5cx_get_ranging_data_fixed(&dev, &fixed);
+            });
+
+    printf("%dx%d  results+convert %7.1f ns  float %7.1f ns  q16 %7.1f ns\n",
+            resolution == 16 ? 4 : 8, resolution == 16 ? 4 : 8,
+            resultsNs, floatNs, fixedNs);
+
+    return true;
+}
+
+int main(void)
+{
+    return run(VL53L5CX_RESOLUTION_4X4) && run(VL53L5CX_RESOLUTION_8X8) ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+/*
+   Compares reading distances and statuses through VL53L5CX_ResultsData with
+   reading them through a VL53L5CX_FrameView over the receive buffer
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#include "fake_sensor.h"
+#include "vl53l5cx_frame_view.hpp"
+
+#include <chrono>
+#include <stdio.h>
+
+static const uint32_t FRAMES = 200000;
+
+static volatile int32_t sink;
+
+static double readResults(VL53L5CX_Configuration * p_dev,
+        VL53L5CX_ResultsData * p_results)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t k=0; k<FRAMES; ++k) {
+        vl53l5cx_get_ranging_data(p_dev, p_results);
+        int32_t sum = 0;
+        for (uint8_t z=0; z<p_results->nb_zones; ++z) {
+            sum += p_results->distance_mm[p_results->nb_target_per_zone * z] +
+                p_results->target_status[p_results->nb_target_per_zone * z];
+        }
+        sink = sum;
+    }
+
+    const auto stop = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(stop - start).count() /
+        FRAMES;
+}
+
+static double readView(VL53L5CX_Configuration * p_dev)
+{
+    VL53L5CX_FrameView view;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t k=0; k<FRAMES; ++k) {
+        vl53l5cx_get_raw_data(p_dev, NULL);
+        view.attach(p_dev);
+        int32_t sum = 0;
+        for (uint8_t z=0; z<view.zones(); ++z) {
+            sum += view.getDistanceMm(z) + view.getTargetStatus(z);
+        }
+        sink = sum;
+    }
+
+    const auto stop = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(stop - start).count() /
+        FRAMES;
+}
+
+static bool run(const uint8_t resolution)
+{
+    static VL53L5CX_Configuration dev;
+    static VL53L5CX_ResultsData results;
+
+    fakeSensor.attach(&dev, resolution);
+
+    if (vl53l5cx_start_ranging(&dev)) {
+        printf("start_ranging failed\n");
+        return false;
+    }
+
+    fakeSensor.newFrame();
+
+    // Both paths must agree on the same frame
+    VL53L5CX_FrameView view;
+    vl53l5cx_get_ranging_data(&dev, &results);
+    vl53l5cx_get_raw_data(&dev, NULL);
+    if (!view.attach(&dev) || view.zones() != results.nb_zones) {
+        printf("attach failed\n");
+        return false;
+    }
+    for (uint8_t z=0; z<view.zones(); ++z) {
+        const uint8_t i = results.nb_target_per_zone * z;
+        if (view.getDistanceMm(z) != results.distance_mm[i] ||
+                view.getTargetStatus(z) != results.target_status[i] ||
+                view.getAmbientPerSpad(z) != results.ambient_per_spad[z] ||
+                view.getRangeSigmaMm(z) != results.range_sigma_mm[i]) {
+            printf("zone %u: view and results disagree\n", z);
+            return false;
+        }
+    }
+
+    const double resultsNs = readResults(&dev, &results);
+    const double viewNs = readView(&dev);
+
+    printf("%dx%d  results %7.1f ns  view %7.1f ns  (%.2fx)  "
+            "%u bytes of results saved\n",
+            resolution == 16 ? 4 : 8, resolution == 16 ? 4 : 8,
+            resultsNs, viewNs, resultsNs / viewNs,
+            (unsigned)sizeof(VL53L5CX_ResultsData));
+
+    return true;
+}
+
+int main(void)
+{
+    return run(VL53L5CX_RESOLUTION_4X4) && run(VL53L5CX_RESOLUTION_8X8) ? 0 : 1;
+}
@@ -0,0 +1,236 @@
+/*
+   Host emulation of a VL53L5CX sensor
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#include "fake_sensor.h"
+#include "Arduino.h"
+
+#include <string.h>
+
+FakeSensor fakeSensor;
+
+HostSerial Serial;
+
+// Firmware sends and expects 32-bit big-endian words
+static void swap(uint8_t * buffer, const uint32_t size)
+{
+    for (uint32_t i=0; i<size; i+=4) {
+        uint8_t tmp = buffer[i];
+        buffer[i] = buffer[i+3];
+        buffer[i+3] = tmp;
+        tmp = buffer[i+1];
+        buffer[i+1] = buffer[i+2];
+        buffer[i+2] = tmp;
+    }
+}
+
+FakeSensor::FakeSensor(void)
+{
+    memset(m_memory, 0, sizeof(m_memory));
+    memset(m_outputList, 0, sizeof(m_outputList));
+    memset(m_outputEnables, 0, sizeof(m_outputEnables));
+    memset(m_zoneConfig, 0, sizeof(m_zoneConfig));
+
+    m_streamCount = 0;
+    m_seed = 1;
+    m_frameSize = 0;
+}
+
+void FakeSensor::attach(VL53L5CX_Configuration * p_dev, const uint8_t resolution)
+{
+    vl53l5cx_config_init(p_dev);
+    p_dev->platform.address = 0x29;
+    p_dev->platform.device = this;
+    vl53l5cx_set_outputs(p_dev, VL53L5CX_OUTPUT_ALL);
+    p_dev->nb_target_per_zone = 1;
+
+    m_zoneConfig[0] = resolution == 16 ? 4 : 8;
+    m_zoneConfig[1] = m_zoneConfig[0];
+}
+
+uint32_t FakeSensor::random(void)
+{
+    m_seed = m_seed * 1103515245 + 12345;
+    return m_seed >> 8;
+}
+
+uint8_t * FakeSensor::dci(const uint16_t index, const uint16_t size)
+{
+    switch (index) {
+        case VL53L5CX_DCI_ZONE_CONFIG:
+            return size <= sizeof(m_zoneConfig) ? m_zoneConfig : NULL;
+        case VL53L5CX_DCI_OUTPUT_LIST:
+            return size <= sizeof(m_outputList) ? m_outputList : NULL;
+        case VL53L5CX_DCI_OUTPUT_ENABLES:
+            return size <= sizeof(m_outputEnables) ? m_outputEnables : NULL;
+        default:
+            return NULL;
+    }
+}
+
+// Handles a command whose last byte was written at VL53L5CX_UI_CMD_END
+void FakeSensor::command(const uint16_t start, const uint32_t count)
+{
+    uint8_t * cmd = &m_memory[start];
+
+    // Every command succeeds at once
+    m_memory[VL53L5CX_UI_CMD_STATUS + 1] = 0x03;
+    m_memory[VL53L5CX_UI_CMD_STATUS + 2] = 0x00;
+
+    if (count < 12) {
+        return;
+    }
+
+    const uint16_t index = (uint16_t)((cmd[0] << 8) | cmd[1]);
+    const uint16_t size = (uint16_t)((cmd[2] << 4) | (cmd[3] >> 4));
+
+    // DCI write: header, data, footer ending with 0x05 0x01 size
+    if (cmd[count-4] == 0x05 && cmd[count-3] == 0x01) {
+        uint8_t * p = dci(index, size);
+        if (p) {
+            memcpy(p, &cmd[4], size);
+            swap(p, size);
+        }
+        if (index == VL53L5CX_DCI_OUTPUT_CONFIG) {
+            uint8_t config[8];
+            memcpy(config, &cmd[4], sizeof(config));
+            swap(config, sizeof(config));
+            memcpy(&m_frameSize, config, 4);
+        }
+    }
+
+    // DCI read: answer is header, data, footer at VL53L5CX_UI_CMD_START
+    else if (cmd[count-4] == 0x00 && cmd[count-3] == 0x02) {
+        uint8_t * answer = &m_memory[VL53L5CX_UI_CMD_START];
+        uint8_t * p = dci(index, size);
+        memset(answer, 0, size + 12);
+        if (p) {
+            memcpy(&answer[4], p, size);
+        }
+        swap(answer, size + 12);
+    }
+}
+
+void FakeSensor::newFrame(void)
+{
+    uint8_t * frame = m_memory;
+
+    const uint8_t resolution = m_zoneConfig[0] * m_zoneConfig[1];
+
+    uint32_t enables = 0;
+    memcpy(&enables, m_outputEnables, 4);
+
+    memset(frame, 0, m_frameSize);
+
+    uint32_t pos = 12;
+
+    for (uint32_t i=0; i<sizeof(m_outputList)/4 && pos<m_frameSize; ++i) {
+
+        if (!(enables & (1u << i))) {
+            continue;
+        }
+
+        uint32_t header = 0;
+        memcpy(&header, &m_outputList[4*i], 4);
+
+        const uint32_t type = header & 0x0f;
+        const uint32_t size = (header >> 4) & 0xfff;
+        const uint32_t msize = (type > 1 && type < 0x0d) ? type * size : size;
+
+        memcpy(&frame[pos], &header, 4);
+        pos += 4;
+
+        for (uint32_t k=0; k<msize; k+=4) {
+            const uint32_t value = random();
+            memcpy(&frame[pos+k], &value, 4);
+        }
+
+        // Keep at least one target in most zones
+        if ((header >> 16) == VL53L5CX_NB_TARGET_DETECTED_IDX) {
+            for (uint32_t k=0; k<resolution; ++k) {
+                frame[pos+k] = (uint8_t)(random() % 5 ? 1 : 0);
+            }
+        }
+
+        pos += msize;
+    }
+
+    swap(frame, m_frameSize);
+
+    // Stream count 255 means no frame yet
+    m_streamCount = (uint8_t)((m_streamCount + 1) % 255);
+
+    frame[0] = m_streamCount;
+    frame[1] = 0x05;
+    frame[2] = 0x05;
+    frame[3] = 0x10;
+}
+
+uint8_t FakeSensor::read(const uint16_t rgstr, uint8_t * data, const uint32_t count)
+{
+    if ((uint32_t)rgstr + count > sizeof(m_memory)) {
+        return 1;
+    }
+
+    // Keep MCU stop and firmware boot polls happy
+    m_memory[0x06] = 0x80;
+
+    memcpy(data, &m_memory[rgstr], count);
+
+    return 0;
+}
+
+uint8_t FakeSensor::write(const uint16_t rgstr, const uint8_t * data,
+        const uint32_t count)
+{
+    if ((uint32_t)rgstr + count > sizeof(m_memory)) {
+        return 1;
+    }
+
+    memcpy(&m_memory[rgstr], data, count);
+
+    if (rgstr + count - 1 == VL53L5CX_UI_CMD_END) {
+        command(rgstr, count);
+    }
+
+    return 0;
+}
+
+// Platform functions used by the ST driver ----------------------------------
+
+uint8_t VL53L1CX_ReadMulti(
+        VL53L5CX_Platform *p_platform,
+        uint16_t rgstr,
+        uint8_t *data,
+        uint32_t count)
+{
+    return ((FakeSensor *)p_platform->device)->read(rgstr, data, count);
+}
+
+uint8_t VL53L1CX_WriteMulti(
+        VL53L5CX_Platform *p_platform,
+        uint16_t rgstr,
+        uint8_t *data,
+        uint32_t count)
+{
+    return ((FakeSensor *)p_platform->device)->write(rgstr, data, count);
+}
+
+void delay(const uint32_t msec)
+{
+    (void)msec;
+}
+
+uint32_t micros(void)
+{
+    return 0;
+}
+
+uint32_t millis(void)
+{
+    return 0;
+}
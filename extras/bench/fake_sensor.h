@@ -0,0 +1,75 @@
+/*
+   Host emulation of a VL53L5CX sensor, for benchmarking the driver without
+   hardware.  Emulates the DCI command interface and synthesizes frames
+   matching the output list written by vl53l5cx_start_ranging().
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#pragma once
+
+#include "st/vl53l5cx_api.h"
+
+#include <chrono>
+
+class FakeSensor {
+
+    public:
+
+        FakeSensor(void);
+
+        // Initializes a driver configuration as vl53l5cx_init() would
+        void attach(VL53L5CX_Configuration * p_dev, const uint8_t resolution);
+
+        // Fills the next frame with fresh values and raises the data-ready
+        // flags
+        void newFrame(void);
+
+        uint8_t read(const uint16_t rgstr, uint8_t * data, const uint32_t count);
+
+        uint8_t write(const uint16_t rgstr, const uint8_t * data,
+                const uint32_t count);
+
+    private:
+
+        static const uint16_t DCI_SIZE = 0x100;
+
+        uint8_t m_memory[0x10000];
+
+        uint8_t m_zoneConfig[8];
+        uint8_t m_outputList[DCI_SIZE];
+        uint8_t m_outputEnables[16];
+
+        uint8_t m_streamCount;
+        uint32_t m_seed;
+
+        uint32_t m_frameSize;
+
+        void command(const uint16_t start, const uint32_t count);
+
+        uint8_t * dci(const uint16_t index, const uint16_t size);
+
+        uint32_t random(void);
+
+}; // class FakeSensor
+
+extern FakeSensor fakeSensor;
+
+// Mean time of a call to read(k), in ns, over frames calls with k counting
+// them from 0
+template <typename F>
+double measure(const uint32_t frames, F read)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t k=0; k<frames; ++k) {
+        read(k);
+    }
+
+    const auto stop = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(stop - start).count() /
+        frames;
+}
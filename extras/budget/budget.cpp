@@ -0,0 +1,153 @@
+/*
+   Prints the memory and bus budget of VL53L5CX configurations, as computed
+   at compile time by VL53L5CX_Budget
+
+   Usage: budget [-a]
+
+   Without -a, only common sets of outputs are listed; with -a, every
+   combination of outputs is.  Build with the same VL53L5CX_... macros as the
+   firmware (targets per zone, disabled outputs, maximum resolution).
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#include "vl53l5cx_budget.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+static const uint32_t RANGING =
+    VL53L5CX_OUTPUT_NB_TARGET_DETECTED |
+    VL53L5CX_OUTPUT_DISTANCE_MM |
+    VL53L5CX_OUTPUT_TARGET_STATUS;
+
+static const uint32_t DISTANCE =
+    VL53L5CX_OUTPUT_DISTANCE_MM |
+    VL53L5CX_OUTPUT_TARGET_STATUS;
+
+static const char * NAMES[] = {
+    "amb", "spad", "ntar", "sig", "sigma", "dist", "refl", "stat", "mot"
+};
+
+static void printOutputs(const uint32_t outputs)
+{
+    char text[64] = "";
+
+    for (uint8_t k=0; k<9; ++k) {
+        if (outputs & (VL53L5CX_OUTPUT_AMBIENT_PER_SPAD << k)) {
+            if (text[0]) {
+                strcat(text, "+");
+            }
+            strcat(text, NAMES[k]);
+        }
+    }
+
+    printf("%-42s", text[0] ? text : "-");
+}
+
+template <uint8_t RESOLUTION, uint8_t TARGETS, uint32_t OUTPUTS>
+static void printRow(void)
+{
+    typedef VL53L5CX_Budget<RESOLUTION, TARGETS, OUTPUTS> Budget;
+
+    printf("%dx%d  %u  ", RESOLUTION == 16 ? 4 : 8, RESOLUTION == 16 ? 4 : 8,
+            (unsigned)TARGETS);
+    printOutputs(OUTPUTS);
+    printf(" %6u %6u %6u %7u\n",
+            (unsigned)Budget::FRAME_BYTES,
+            (unsigned)Budget::sensorRam(false),
+            (unsigned)Budget::sensorRam(true),
+            (unsigned)Budget::busBytesPerSecond(
+                RESOLUTION == 16 ? 60 : 15));
+}
+
+template <uint8_t RESOLUTION, uint8_t TARGETS>
+static void printCommon(void)
+{
+    printRow<RESOLUTION, TARGETS, VL53L5CX_OUTPUT_ALL>();
+    printRow<RESOLUTION, TARGETS, RANGING>();
+    printRow<RESOLUTION, TARGETS, DISTANCE>();
+}
+
+// Every combination of the nine optional outputs, by recursion on their mask
+template <uint8_t RESOLUTION, uint8_t TARGETS, uint16_t MASK>
+struct AllOutputs {
+
+    static void print(void)
+    {
+        AllOutputs<RESOLUTION, TARGETS, MASK - 1>::print();
+        printRow<RESOLUTION, TARGETS,
+            (uint32_t)MASK * VL53L5CX_OUTPUT_AMBIENT_PER_SPAD>();
+    }
+};
+
+template <uint8_t RESOLUTION, uint8_t TARGETS>
+struct AllOutputs<RESOLUTION, TARGETS, 0> {
+
+    static void print(void)
+    {
+        printRow<RESOLUTION, TARGETS, 0>();
+    }
+};
+
+// Every number of targets up to VL53L5CX_NB_TARGET_PER_ZONE
+template <uint8_t TARGETS>
+struct AllTargets {
+
+    static void print(const bool all)
+    {
+        AllTargets<TARGETS - 1>::print(all);
+
+        if (all) {
+            AllOutputs<VL53L5CX_RESOLUTION_4X4, TARGETS, 511>::print();
+            AllOutputs<VL53L5CX_RESOLUTION_8X8, TARGETS, 511>::print();
+        }
+        else {
+            printCommon<VL53L5CX_RESOLUTION_4X4, TARGETS>();
+            printCommon<VL53L5CX_RESOLUTION_8X8, TARGETS>();
+        }
+    }
+};
+
+template <>
+struct AllTargets<0> {
+
+    static void print(const bool all)
+    {
+        (void)all;
+    }
+};
+
+int main(int argc, char ** argv)
+{
+    typedef VL53L5CX_Budget<VL53L5CX_RESOLUTION_8X8> Budget;
+
+    const bool all = argc > 1 && strcmp(argv[1], "-a") == 0;
+
+    printf("Flash, stored once  %6u bytes (firmware %u, configuration %u, "
+            "xtalk %u)\n",
+            (unsigned)Budget::FLASH, (unsigned)VL53L5CX_FIRMWARE_SIZE,
+            (unsigned)VL53L5CX_CONFIGURATION_SIZE,
+            (unsigned)VL53L5CX_XTALK_BUFFER_SIZE);
+    printf("Scratch, shared     %6u bytes\n", (unsigned)Budget::SCRATCH_RAM);
+    printf("Configuration       %6u bytes per sensor\n",
+            (unsigned)Budget::CONFIG_RAM);
+    printf("Calibration         %6u bytes per sensor\n",
+            (unsigned)Budget::CALIBRATION_RAM);
+    printf("Xtalk storage       %6u bytes per sensor calibrating xtalk\n",
+            (unsigned)Budget::XTALK_RAM);
+    printf("\n");
+
+    printf("Per sensor, without the scratch: RAM of VL53L5CX and of "
+            "VL53L5CX_Static,\nand bytes read per second at the highest "
+            "frequency (60 Hz at 4x4, 15 Hz at 8x8)\n\n");
+
+    printf("res  t  %-42s %6s %6s %6s %7s\n", "outputs", "frame",
+            "RAM", "static", "bus B/s");
+
+    AllTargets<VL53L5CX_NB_TARGET_PER_ZONE>::print(all);
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include "vl53l5cx_api.h"
 #include "vl53l5cx_buffers.h"
@@ -7,16 +8,85 @@
 
 #include "debugger.hpp"
 
-static void SwapBuffer(uint8_t * buffer, uint16_t size) {
+// Fixed transfers through the temporary buffer; frames are checked by
+// vl53l5cx_start_ranging()
+static_assert(VL53L5CX_NVM_DATA_SIZE <= VL53L5CX_TEMPORARY_BUFFER_SIZE,
+        "VL53L5CX temporary buffer is too small for the NVM data");
+static_assert(VL53L5CX_OFFSET_BUFFER_SIZE <= VL53L5CX_TEMPORARY_BUFFER_SIZE,
+        "VL53L5CX temporary buffer is too small for the offset data");
+static_assert(VL53L5CX_XTALK_BUFFER_SIZE <= VL53L5CX_TEMPORARY_BUFFER_SIZE,
+        "VL53L5CX temporary buffer is too small for the xtalk data");
+
+// Sizes published for memory budgets
+static_assert(sizeof(VL53L5CX_FIRMWARE) == VL53L5CX_FIRMWARE_SIZE,
+        "VL53L5CX_FIRMWARE_SIZE does not match the firmware");
+static_assert(sizeof(VL53L5CX_DEFAULT_CONFIGURATION)
+        == VL53L5CX_CONFIGURATION_SIZE,
+        "VL53L5CX_CONFIGURATION_SIZE does not match the configuration");
+static_assert(sizeof(VL53L5CX_DEFAULT_XTALK) == VL53L5CX_XTALK_BUFFER_SIZE,
+        "VL53L5CX_XTALK_BUFFER_SIZE does not match the default xtalk");
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define VL53L5CX_SWAP_AVX2
+#define VL53L5CX_SWAP_SSSE3
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#define VL53L5CX_SWAP_SSSE3
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define VL53L5CX_SWAP_NEON
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define VL53L5CX_SWAP_BUILTIN
+#endif
+#endif
+
+void vl53l5cx_swap_buffer(uint8_t * buffer, uint16_t size) {
+
+    uint32_t i = 0;
+
+    // Sizes are always a multiple of 4 bytes, so vector loops only leave
+    // whole words for the scalar loop
+#if defined(VL53L5CX_SWAP_AVX2)
+    const __m256i mask32 = _mm256_setr_epi8(
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    for(; (i + 32) <= size; i = i + 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)&(buffer[i]));
+        _mm256_storeu_si256((__m256i *)&(buffer[i]),
+                _mm256_shuffle_epi8(v, mask32));
+    }
+#endif
+
+#if defined(VL53L5CX_SWAP_SSSE3)
+    const __m128i mask16 = _mm_setr_epi8(
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    for(; (i + 16) <= size; i = i + 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)&(buffer[i]));
+        _mm_storeu_si128((__m128i *)&(buffer[i]), _mm_shuffle_epi8(v, mask16));
+    }
+#elif defined(VL53L5CX_SWAP_NEON)
+    for(; (i + 16) <= size; i = i + 16) {
+        vst1q_u8(&(buffer[i]), vrev32q_u8(vld1q_u8(&(buffer[i]))));
+    }
+#endif
 
-    // Example of possible implementation using <string.h>
-    for(uint32_t i = 0; i < size; i = i + 4) {
+    for(; i < size; i = i + 4) {
 
+#if defined(VL53L5CX_SWAP_BUILTIN)
+        uint32_t tmp;
+        memcpy(&tmp, &(buffer[i]), 4);
+        tmp = __builtin_bswap32(tmp);
+#else
+        // Example of possible implementation using <string.h>
         uint32_t tmp = (
                 buffer[i]<<24)
             |(buffer[i+1]<<16)
             |(buffer[i+2]<<8)
             |(buffer[i+3]);
+#endif
 
         memcpy(&(buffer[i]), &tmp, 4);
     }
@@ -59,6 +129,10 @@ static uint8_t _vl53l5cx_poll_for_answer(
     uint8_t status = VL53L5CX_STATUS_OK;
     uint8_t timeout = 0;
 
+    /* Every command polls for its answer in the scratch, so this is where
+     * the last frame read into it is lost */
+    p_dev->p_scratch->p_frame_owner = NULL;
+
     do {
         status |= VL53L1CX_ReadMulti(&(p_dev->platform), address,
                 p_dev->temp_buffer, size);
@@ -102,12 +176,12 @@ static uint8_t _vl53l5cx_send_offset_data(
     int8_t i, j;
 
     (void)memcpy(p_dev->temp_buffer,
-            p_dev->offset_data, VL53L5CX_OFFSET_BUFFER_SIZE);
+            p_dev->p_calibration->offset_data, VL53L5CX_OFFSET_BUFFER_SIZE);
 
     /* Data extrapolation is required for 4X4 offset */
     if(resolution == (uint8_t)VL53L5CX_RESOLUTION_4X4){
         (void)memcpy(&(p_dev->temp_buffer[0x10]), dss_4x4, sizeof(dss_4x4));
-        SwapBuffer(p_dev->temp_buffer, VL53L5CX_OFFSET_BUFFER_SIZE);
+        vl53l5cx_swap_buffer(p_dev->temp_buffer, VL53L5CX_OFFSET_BUFFER_SIZE);
         (void)memcpy(signal_grid,&(p_dev->temp_buffer[0x3C]),
                 sizeof(signal_grid));
         (void)memcpy(range_grid,&(p_dev->temp_buffer[0x140]),
@@ -137,7 +211,7 @@ static uint8_t _vl53l5cx_send_offset_data(
                 signal_grid, sizeof(signal_grid));
         (void)memcpy(&(p_dev->temp_buffer[0x140]),
                 range_grid, sizeof(range_grid));
-        SwapBuffer(p_dev->temp_buffer, VL53L5CX_OFFSET_BUFFER_SIZE);
+        vl53l5cx_swap_buffer(p_dev->temp_buffer, VL53L5CX_OFFSET_BUFFER_SIZE);
     }
 
     (void)memcpy(p_dev->temp_buffer, &(p_dev->temp_buffer[8]),
@@ -168,7 +242,7 @@ static uint8_t _vl53l5cx_send_xtalk_data(
     uint32_t signal_grid[64];
     int8_t i, j;
 
-    (void)memcpy(p_dev->temp_buffer, &(p_dev->xtalk_data[0]),
+    (void)memcpy(p_dev->temp_buffer, p_dev->p_xtalk_data,
             VL53L5CX_XTALK_BUFFER_SIZE);
 
     /* Data extrapolation is required for 4X4 Xtalk */
@@ -179,7 +253,7 @@ static uint8_t _vl53l5cx_send_xtalk_data(
         (void)memcpy(&(p_dev->temp_buffer[0x020]),
                 dss_4x4, sizeof(dss_4x4));
 
-        SwapBuffer(p_dev->temp_buffer, VL53L5CX_XTALK_BUFFER_SIZE);
+        vl53l5cx_swap_buffer(p_dev->temp_buffer, VL53L5CX_XTALK_BUFFER_SIZE);
         (void)memcpy(signal_grid, &(p_dev->temp_buffer[0x34]),
                 sizeof(signal_grid));
 
@@ -197,7 +271,7 @@ static uint8_t _vl53l5cx_send_xtalk_data(
         (void)memset(&signal_grid[0x10], 0, (uint32_t)192);
         (void)memcpy(&(p_dev->temp_buffer[0x34]),
                 signal_grid, sizeof(signal_grid));
-        SwapBuffer(p_dev->temp_buffer, VL53L5CX_XTALK_BUFFER_SIZE);
+        vl53l5cx_swap_buffer(p_dev->temp_buffer, VL53L5CX_XTALK_BUFFER_SIZE);
         (void)memcpy(&(p_dev->temp_buffer[0x134]),
                 profile_4x4, sizeof(profile_4x4));
         (void)memset(&(p_dev->temp_buffer[0x078]),0 ,
@@ -229,18 +303,119 @@ static uint8_t _vl53l5cx_send_xtalk_data(
      (target_status == TARGET_STATUS_PHASECONSISTENCY) || \
      (target_status == TARGET_STATUS_MINSIGNALEVENTCHECK))
 
+static inline uint32_t _vl53l5cx_swap_word(
+        const uint8_t			*p_src);
+
+/**
+ * @brief Inner function, not available outside this file. This function gives
+ * the offset of a block in the raw frame, or 0 if it is not in the plan.
+ */
+
+static uint16_t _vl53l5cx_plan_src_offset(
+        VL53L5CX_Configuration		*p_dev,
+        uint16_t			idx)
+{
+    uint8_t i;
+
+    for(i = 0; i < p_dev->decode_plan_size; i++)
+    {
+        if(p_dev->decode_plan[i].idx == idx)
+        {
+            return p_dev->decode_plan[i].src_offset;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Inner function, not available outside this file. This function gives
+ * the distance of a target in mm, decoded or read from the raw frame.
+ */
+
+static int16_t _vl53l5cx_ltf_distance(
+        VL53L5CX_Configuration		*p_dev,
+        const int16_t			*p_distance_mm,
+        uint16_t			src_offset,
+        uint16_t			k)
+{
+    uint32_t word;
+    int16_t i16[2];
+
+    if(p_distance_mm != NULL)
+    {
+        return p_distance_mm[k];
+    }
+
+    word = _vl53l5cx_swap_word(&(p_dev->temp_buffer[src_offset
+                + ((k / (uint16_t)2) * (uint16_t)4)]));
+    (void)memcpy(i16, &word, 4);
+
+    return (i16[k & (uint16_t)1] < 0) ? (int16_t)0
+        : (int16_t)(i16[k & (uint16_t)1] / 4);
+}
+
+/**
+ * @brief Inner function, not available outside this file. This function gives
+ * the signal of a target in kcps/spads, decoded or read from the raw frame.
+ */
+
+static uint32_t _vl53l5cx_ltf_signal(
+        VL53L5CX_Configuration		*p_dev,
+        const uint32_t			*p_signal_per_spad,
+        uint16_t			src_offset,
+        uint16_t			k)
+{
+    if(p_signal_per_spad != NULL)
+    {
+        return p_signal_per_spad[k];
+    }
+
+    return _vl53l5cx_swap_word(&(p_dev->temp_buffer[src_offset
+                + (k * (uint16_t)4)])) / (uint32_t)2048;
+}
+
 /**
- * @brief This function removed the false targets of the tail
+ * @brief This function removed the false targets of the tail. Distances and
+ * signals are read from the raw frame when they are not given, for the
+ * results which do not hold them in mm and kcps/spads.
  * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
- * @param (VL53L5CX_ResultsData_t) *p_results : Ranging data
+ * @param (uint8_t) *p_nb_target_detected : Decoded number of targets per zone.
+ * @param (uint8_t) *p_target_status : Decoded target status, updated.
+ * @param (int16_t) *p_distance_mm : Decoded distances, or NULL.
+ * @param (uint32_t) *p_signal_per_spad : Decoded signals, or NULL.
  */
 static uint8_t _vl53l5cx_remove_false_target(
         VL53L5CX_Configuration *p_dev,
-        VL53L5CX_ResultsData *p_results) {
+        const uint8_t *p_nb_target_detected,
+        uint8_t *p_target_status,
+        const int16_t *p_distance_mm,
+        const uint32_t *p_signal_per_spad) {
 
     uint8_t target_order, zone_id, nb_of_targets, index, false_target, nb_of_zones;
     uint32_t signal_first_target, signal;
     int16_t distance_first_target, distance;
+    uint16_t distance_src = 0, signal_src = 0;
+
+    const uint32_t inputs = VL53L5CX_OUTPUT_NB_TARGET_DETECTED
+        | VL53L5CX_OUTPUT_SIGNAL_PER_SPAD | VL53L5CX_OUTPUT_DISTANCE_MM
+        | VL53L5CX_OUTPUT_TARGET_STATUS;
+
+    // Nothing to filter without every field the filter uses
+    if ((p_dev->outputs & inputs) != inputs)
+        return VL53L5CX_STATUS_OK;
+
+    if (p_distance_mm == NULL) {
+        distance_src = _vl53l5cx_plan_src_offset(p_dev, VL53L5CX_DISTANCE_IDX);
+        if (distance_src == 0)
+            return VL53L5CX_STATUS_ERROR;
+    }
+
+    if (p_signal_per_spad == NULL) {
+        signal_src = _vl53l5cx_plan_src_offset(p_dev, VL53L5CX_SIGNAL_RATE_IDX);
+        if (signal_src == 0)
+            return VL53L5CX_STATUS_ERROR;
+    }
 
     nb_of_zones = p_dev->resolution;
     target_order = p_dev->target_order;
@@ -256,21 +431,25 @@ static uint8_t _vl53l5cx_remove_false_target(
     zone_id=0;
     while (zone_id<nb_of_zones) {
         // if less than 2 tarets in this zone, nothing to be filtered out
-        nb_of_targets = p_results->nb_target_detected[zone_id];
+        nb_of_targets = p_nb_target_detected[zone_id];
+        if (nb_of_targets > p_dev->nb_target_per_zone)
+            nb_of_targets = p_dev->nb_target_per_zone;
         if (nb_of_targets < 2)
             goto next_zone;
 
         // skip this zone if first target in the list is unvalid
-        if (IS_TARGET_INVALID(p_results->target_status[zone_id*VL53L5CX_NB_TARGET_PER_ZONE]))
+        if (IS_TARGET_INVALID(p_target_status[zone_id*p_dev->nb_target_per_zone]))
             goto next_zone;
 
         index = 1;
         if (target_order == VL53L5CX_TARGET_ORDER_STRONGEST) {
             // find closest target
-            distance_first_target = p_results->distance_mm[zone_id*VL53L5CX_NB_TARGET_PER_ZONE];
+            distance_first_target = _vl53l5cx_ltf_distance(p_dev, p_distance_mm, distance_src,
+                        zone_id*p_dev->nb_target_per_zone);
             while (index < nb_of_targets) {
                 // if closest is not strongest, continue to next zone
-                if (p_results->distance_mm[zone_id*VL53L5CX_NB_TARGET_PER_ZONE + index] < distance_first_target)
+                if (_vl53l5cx_ltf_distance(p_dev, p_distance_mm, distance_src,
+                        zone_id*p_dev->nb_target_per_zone + index) < distance_first_target)
                     // nothing to filter on this zone, go to next one
                     goto next_zone;
                 index++;
@@ -278,10 +457,12 @@ static uint8_t _vl53l5cx_remove_false_target(
         }
         else {
             // find stronget and check if its also the stongest
-            signal_first_target = p_results->signal_per_spad[zone_id*VL53L5CX_NB_TARGET_PER_ZONE];
+            signal_first_target = _vl53l5cx_ltf_signal(p_dev, p_signal_per_spad, signal_src,
+                        zone_id*p_dev->nb_target_per_zone);
             while (index < nb_of_targets) {
                 // if closest is not strongest, continue to next zone
-                if (p_results->signal_per_spad[zone_id*VL53L5CX_NB_TARGET_PER_ZONE + index] > signal_first_target)
+                if (_vl53l5cx_ltf_signal(p_dev, p_signal_per_spad, signal_src,
+                        zone_id*p_dev->nb_target_per_zone + index) > signal_first_target)
                     // nothing to filter on this zone, go to next one
                     goto next_zone;
                 index++;
@@ -289,17 +470,21 @@ static uint8_t _vl53l5cx_remove_false_target(
         }
 
         index = 1;
-        signal_first_target = p_results->signal_per_spad[zone_id*VL53L5CX_NB_TARGET_PER_ZONE];
-        distance_first_target = p_results->distance_mm[zone_id*VL53L5CX_NB_TARGET_PER_ZONE];
+        signal_first_target = _vl53l5cx_ltf_signal(p_dev, p_signal_per_spad, signal_src,
+                        zone_id*p_dev->nb_target_per_zone);
+        distance_first_target = _vl53l5cx_ltf_distance(p_dev, p_distance_mm, distance_src,
+                        zone_id*p_dev->nb_target_per_zone);
         // look if any of the following targets is a false target of the tail
         while (index < nb_of_targets) {
 
-            if (IS_TARGET_INVALID(p_results->target_status[zone_id*VL53L5CX_NB_TARGET_PER_ZONE + index]))
+            if (IS_TARGET_INVALID(p_target_status[zone_id*p_dev->nb_target_per_zone + index]))
                 // skip this target
                 goto next_index;
 
-            signal = p_results->signal_per_spad[zone_id*VL53L5CX_NB_TARGET_PER_ZONE + index];
-            distance = p_results->distance_mm[zone_id*VL53L5CX_NB_TARGET_PER_ZONE + index];
+            signal = _vl53l5cx_ltf_signal(p_dev, p_signal_per_spad, signal_src,
+                        zone_id*p_dev->nb_target_per_zone + index);
+            distance = _vl53l5cx_ltf_distance(p_dev, p_distance_mm, distance_src,
+                        zone_id*p_dev->nb_target_per_zone + index);
 
             // Debugger::printf("LT_filter : %d,%d  ", distance - distance_first_target, (signal_first_target/(signal+1)));
 
@@ -334,7 +519,7 @@ static uint8_t _vl53l5cx_remove_false_target(
 
             if (false_target)
                 // this is a false target of the tail
-                p_results->target_status[zone_id*VL53L5CX_NB_TARGET_PER_ZONE+index] = TARGET_STATUS_TAILTARGETCHECK;
+                p_target_status[zone_id*p_dev->nb_target_per_zone+index] = TARGET_STATUS_TAILTARGETCHECK;
 
 next_index:
             index++;
@@ -344,9 +529,496 @@ next_zone:
         zone_id++;
     }
 
-    return VL53L5CX_STATUS_OK;
+    return VL53L5CX_STATUS_OK;
+}
+#endif
+
+/**
+ * @brief Inner function, not available outside this file. This function gives
+ * the position into VL53L5CX_ResultsData and the conversion of an output block.
+ * It returns an error if the block is not decoded.
+ */
+
+static uint8_t _vl53l5cx_decode_target(
+        uint16_t			idx,
+        uint16_t			*p_dst_offset,
+        uint8_t				*p_conversion)
+{
+    uint8_t status = VL53L5CX_STATUS_OK;
+
+    switch(idx){
+#ifndef VL53L5CX_DISABLE_AMBIENT_PER_SPAD
+        case VL53L5CX_AMBIENT_RATE_IDX:
+            *p_dst_offset = offsetof(VL53L5CX_ResultsData, ambient_per_spad);
+            *p_conversion = VL53L5CX_CONVERSION_KCPS;
+            break;
+#endif
+#ifndef VL53L5CX_DISABLE_NB_SPADS_ENABLED
+        case VL53L5CX_SPAD_COUNT_IDX:
+            *p_dst_offset = offsetof(VL53L5CX_ResultsData, nb_spads_enabled);
+            *p_conversion = VL53L5CX_CONVERSION_NONE;
+            break;
+#endif
+#ifndef VL53L5CX_DISABLE_NB_TARGET_DETECTED
+        case VL53L5CX_NB_TARGET_DETECTED_IDX:
+            *p_dst_offset = offsetof(VL53L5CX_ResultsData, nb_target_detected);
+            *p_conversion = VL53L5CX_CONVERSION_NONE;
+            break;
+#endif
+#ifndef VL53L5CX_DISABLE_SIGNAL_PER_SPAD
+        case VL53L5CX_SIGNAL_RATE_IDX:
+            *p_dst_offset = offsetof(VL53L5CX_ResultsData, signal_per_spad);
+            *p_conversion = VL53L5CX_CONVERSION_KCPS;
+            break;
+#endif
+#ifndef VL53L5CX_DISABLE_RANGE_SIGMA_MM
+        case VL53L5CX_RANGE_SIGMA_MM_IDX:
+            *p_dst_offset = offsetof(VL53L5CX_ResultsData, range_sigma_mm);
+            *p_conversion = VL53L5CX_CONVERSION_SIGMA;
+            break;
+#endif
+#ifndef VL53L5CX_DISABLE_DISTANCE_MM
+        case VL53L5CX_DISTANCE_IDX:
+            *p_dst_offset = offsetof(VL53L5CX_ResultsData, distance_mm);
+            *p_conversion = VL53L5CX_CONVERSION_DISTANCE;
+            break;
+#endif
+#ifndef VL53L5CX_DISABLE_REFLECTANCE_PERCENT
+        case VL53L5CX_REFLECTANCE_EST_PC_IDX:
+            *p_dst_offset = offsetof(VL53L5CX_ResultsData, reflectance);
+            *p_conversion = VL53L5CX_CONVERSION_NONE;
+            break;
+#endif
+#ifndef VL53L5CX_DISABLE_TARGET_STATUS
+        case VL53L5CX_TARGET_STATUS_IDX:
+            *p_dst_offset = offsetof(VL53L5CX_ResultsData, target_status);
+            *p_conversion = VL53L5CX_CONVERSION_STATUS;
+            break;
+#endif
+#ifndef VL53L5CX_DISABLE_MOTION_INDICATOR
+        case VL53L5CX_MOTION_DETEC_IDX:
+            *p_dst_offset = offsetof(VL53L5CX_ResultsData, motion_indicator);
+            *p_conversion = VL53L5CX_CONVERSION_MOTION;
+            break;
+#endif
+        default:
+            status = VL53L5CX_STATUS_ERROR;
+            break;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Inner function, not available outside this file. This function adds
+ * an output block to the decode plan, if the block is decoded.
+ */
+
+static void _vl53l5cx_add_decode_step(
+        VL53L5CX_Configuration		*p_dev,
+        uint16_t			idx,
+        uint16_t			src_offset,
+        uint16_t			size)
+{
+    VL53L5CX_DecodeStep *p_step;
+    uint16_t dst_offset;
+    uint8_t conversion;
+
+    if((p_dev->decode_plan_size < VL53L5CX_MAX_DECODE_STEPS)
+            && (_vl53l5cx_decode_target(idx, &dst_offset, &conversion)
+                == VL53L5CX_STATUS_OK))
+    {
+        p_step = &(p_dev->decode_plan[p_dev->decode_plan_size]);
+        p_step->idx = idx;
+        p_step->src_offset = src_offset;
+        p_step->dst_offset = dst_offset;
+        p_step->size = size;
+        p_step->conversion = conversion;
+        p_dev->decode_plan_size++;
+    }
+}
+
+/**
+ * @brief Inner function, not available outside this file. This function
+ * converts a decoded block from firmware format to real format.
+ */
+
+static void _vl53l5cx_convert_block(
+        uint8_t				*p_field,
+        uint16_t			size,
+        uint8_t				conversion)
+{
+    uint16_t i, n;
+    uint32_t *p_u32;
+    uint16_t *p_u16;
+    int16_t *p_i16;
+
+    switch(conversion){
+        case VL53L5CX_CONVERSION_KCPS:
+            p_u32 = (uint32_t*)p_field;
+            for(i = 0; i < (size / (uint16_t)4); i++)
+            {
+                p_u32[i] /= (uint32_t)2048;
+            }
+            break;
+
+        case VL53L5CX_CONVERSION_SIGMA:
+            p_u16 = (uint16_t*)p_field;
+            for(i = 0; i < (size / (uint16_t)2); i++)
+            {
+                p_u16[i] /= (uint16_t)128;
+            }
+            break;
+
+        case VL53L5CX_CONVERSION_DISTANCE:
+            p_i16 = (int16_t*)p_field;
+            for(i = 0; i < (size / (uint16_t)2); i++)
+            {
+                p_i16[i] /= 4;
+                if(p_i16[i] < 0)
+                {
+                    p_i16[i] = 0;
+                }
+            }
+            break;
+
+#ifndef VL53L5CX_DISABLE_MOTION_INDICATOR
+        case VL53L5CX_CONVERSION_MOTION:
+            /* Only the motion array is converted, not the global fields */
+            p_u32 = ((VL53L5CX_ResultsData*)(p_field
+                        - offsetof(VL53L5CX_ResultsData, motion_indicator)))
+                ->motion_indicator.motion;
+            n = (uint16_t)sizeof(((VL53L5CX_ResultsData*)0)
+                    ->motion_indicator.motion) / (uint16_t)4;
+            for(i = 0; i < n; i++)
+            {
+                p_u32[i] /= (uint32_t)65535;
+            }
+            break;
+#endif
+
+        default:
+            break;
+    }
+
+    (void)n;
+}
+
+/**
+ * @brief Inner function, not available outside this file. This function decodes
+ * a frame by walking every block header.
+ */
+
+static void _vl53l5cx_decode_walk(
+        VL53L5CX_Configuration		*p_dev,
+        VL53L5CX_ResultsData		*p_results)
+{
+    union Block_header *bh_ptr;
+    uint32_t i, msize;
+    uint16_t dst_offset;
+    uint8_t conversion;
+
+    /* Start conversion at position 16 to avoid headers */
+    for (i = (uint32_t)16; i 
+            < (uint32_t)p_dev->data_read_size; i+=(uint32_t)4)
+    {
+        bh_ptr = (union Block_header *)&(p_dev->temp_buffer[i]);
+        if ((bh_ptr->type > (uint32_t)0x1) 
+                && (bh_ptr->type < (uint32_t)0xd))
+        {
+            msize = bh_ptr->type * bh_ptr->size;
+        }
+        else
+        {
+            msize = bh_ptr->size;
+        }
+
+        if(_vl53l5cx_decode_target((uint16_t)bh_ptr->idx, &dst_offset,
+                    &conversion) == VL53L5CX_STATUS_OK)
+        {
+            (void)memcpy((uint8_t*)p_results + dst_offset,
+                    &(p_dev->temp_buffer[i + (uint32_t)4]), msize);
+            _vl53l5cx_convert_block((uint8_t*)p_results + dst_offset,
+                    (uint16_t)msize, conversion);
+        }
+
+        i += msize;
+    }
+}
+
+/**
+ * @brief Inner function, not available outside this file. This function reads
+ * a 32 bits word in firmware format.
+ */
+
+static inline uint32_t _vl53l5cx_swap_word(
+        const uint8_t			*p_src)
+{
+    return ((uint32_t)p_src[0] << 24) | ((uint32_t)p_src[1] << 16)
+        | ((uint32_t)p_src[2] << 8) | (uint32_t)p_src[3];
+}
+
+/**
+ * @brief Inner function, not available outside this file. This function
+ * byte-swaps a block from the receive buffer, converts it to real format and
+ * writes it into its final place, in a single pass.
+ */
+
+static void _vl53l5cx_swap_convert(
+        uint8_t				*p_dst,
+        const uint8_t			*p_src,
+        uint16_t			size,
+        uint8_t				conversion)
+{
+    uint16_t i = 0;
+    uint32_t word;
+    uint16_t u16[2];
+    int16_t i16[2];
+
+#if defined(VL53L5CX_SWAP_SSSE3)
+    const __m128i mask = _mm_setr_epi8(
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m128i zero = _mm_setzero_si128();
+    for(; (i + 16) <= size; i = i + 16) {
+        __m128i v = _mm_shuffle_epi8(
+                _mm_loadu_si128((const __m128i *)&(p_src[i])), mask);
+        if(conversion == VL53L5CX_CONVERSION_KCPS) {
+            v = _mm_srli_epi32(v, 11);
+        }
+        else if(conversion == VL53L5CX_CONVERSION_SIGMA) {
+            v = _mm_srli_epi16(v, 7);
+        }
+        else if(conversion == VL53L5CX_CONVERSION_DISTANCE) {
+            v = _mm_max_epi16(_mm_srai_epi16(v, 2), zero);
+        }
+        _mm_storeu_si128((__m128i *)&(p_dst[i]), v);
+    }
+#elif defined(VL53L5CX_SWAP_NEON)
+    for(; (i + 16) <= size; i = i + 16) {
+        uint8x16_t v = vrev32q_u8(vld1q_u8(&(p_src[i])));
+        if(conversion == VL53L5CX_CONVERSION_KCPS) {
+            v = vreinterpretq_u8_u32(vshrq_n_u32(vreinterpretq_u32_u8(v), 11));
+        }
+        else if(conversion == VL53L5CX_CONVERSION_SIGMA) {
+            v = vreinterpretq_u8_u16(vshrq_n_u16(vreinterpretq_u16_u8(v), 7));
+        }
+        else if(conversion == VL53L5CX_CONVERSION_DISTANCE) {
+            v = vreinterpretq_u8_s16(vmaxq_s16(
+                        vshrq_n_s16(vreinterpretq_s16_u8(v), 2),
+                        vdupq_n_s16(0)));
+        }
+        vst1q_u8(&(p_dst[i]), v);
+    }
+#endif
+
+    /* Remaining words, one loop per conversion to keep them simple */
+    switch(conversion){
+        case VL53L5CX_CONVERSION_KCPS:
+            for(; i < size; i = i + 4) {
+                word = _vl53l5cx_swap_word(&(p_src[i])) / (uint32_t)2048;
+                (void)memcpy(&(p_dst[i]), &word, 4);
+            }
+            break;
+
+        case VL53L5CX_CONVERSION_SIGMA:
+            for(; i < size; i = i + 4) {
+                word = _vl53l5cx_swap_word(&(p_src[i]));
+                (void)memcpy(u16, &word, 4);
+                u16[0] /= (uint16_t)128;
+                u16[1] /= (uint16_t)128;
+                (void)memcpy(&(p_dst[i]), u16, 4);
+            }
+            break;
+
+        case VL53L5CX_CONVERSION_DISTANCE:
+            for(; i < size; i = i + 4) {
+                word = _vl53l5cx_swap_word(&(p_src[i]));
+                (void)memcpy(i16, &word, 4);
+                i16[0] = (i16[0] < 0) ? (int16_t)0 : (int16_t)(i16[0] / 4);
+                i16[1] = (i16[1] < 0) ? (int16_t)0 : (int16_t)(i16[1] / 4);
+                (void)memcpy(&(p_dst[i]), i16, 4);
+            }
+            break;
+
+        default:
+            for(; i < size; i = i + 4) {
+                word = _vl53l5cx_swap_word(&(p_src[i]));
+                (void)memcpy(&(p_dst[i]), &word, 4);
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Inner function, not available outside this file. This function decodes
+ * one block of the plan: the block is swapped, converted and stored in one
+ * pass, straight from the receive buffer. It returns an error if the block
+ * header does not match the plan, leaving the receive buffer untouched.
+ */
+
+static uint8_t _vl53l5cx_decode_step(
+        VL53L5CX_Configuration		*p_dev,
+        VL53L5CX_ResultsData		*p_results,
+        const VL53L5CX_DecodeStep	*p_step)
+{
+    uint8_t status = VL53L5CX_STATUS_OK;
+    uint16_t j, k;
+    union Block_header bh;
+    uint8_t *p_dst;
+
+    bh.bytes = _vl53l5cx_swap_word(&(p_dev->temp_buffer[
+            p_step->src_offset - (uint16_t)4]));
+    if(bh.idx != p_step->idx)
+    {
+        status = VL53L5CX_STATUS_ERROR;
+    }
+    else
+    {
+        p_dst = (uint8_t*)p_results + p_step->dst_offset;
+        _vl53l5cx_swap_convert(p_dst, &(p_dev->temp_buffer[p_step->src_offset]),
+                p_step->size, p_step->conversion);
+
+        if(p_step->conversion == VL53L5CX_CONVERSION_MOTION)
+        {
+            _vl53l5cx_convert_block(p_dst, p_step->size, p_step->conversion);
+        }
+
+#ifndef VL53L5CX_DISABLE_NB_TARGET_DETECTED
+        /* Set target status to 255 if no target is detected for this zone. The
+         * number of targets must be decoded first */
+        else if((p_step->conversion == VL53L5CX_CONVERSION_STATUS)
+                && (p_dev->outputs & VL53L5CX_OUTPUT_NB_TARGET_DETECTED))
+        {
+            for(j = 0; j < (p_step->size
+                        / (uint16_t)p_dev->nb_target_per_zone); j++)
+            {
+                if(p_results->nb_target_detected[j] == (uint8_t)0)
+                {
+                    for(k = 0; k < (uint16_t)p_dev->nb_target_per_zone; k++)
+                    {
+                        p_dst[(j * (uint16_t)p_dev->nb_target_per_zone) + k]
+                            = (uint8_t)255;
+                    }
+                }
+            }
+        }
+#endif
+    }
+
+    (void)j;
+    (void)k;
+
+    return status;
+}
+
+/**
+ * @brief Inner function, not available outside this file. This function decodes
+ * a frame using the plan computed by vl53l5cx_start_ranging(). The number of
+ * targets always comes before the status in the plan. It returns an error if a
+ * block header does not match the plan.
+ */
+
+static uint8_t _vl53l5cx_decode_plan(
+        VL53L5CX_Configuration		*p_dev,
+        VL53L5CX_ResultsData		*p_results)
+{
+    uint8_t i, status = VL53L5CX_STATUS_OK;
+
+    for(i = 0; (i < p_dev->decode_plan_size)
+            && (status == VL53L5CX_STATUS_OK); i++)
+    {
+        status |= _vl53l5cx_decode_step(p_dev, p_results,
+                &(p_dev->decode_plan[i]));
+    }
+
+    return status;
+}
+
+/**
+ * @brief Inner function, not available outside this file. This function gives
+ * the block index of an output flag, or 0 if the flag is unknown.
+ */
+
+static uint16_t _vl53l5cx_output_idx(
+        uint32_t			output)
+{
+    uint16_t idx;
+
+    switch(output){
+        case VL53L5CX_OUTPUT_AMBIENT_PER_SPAD:
+            idx = VL53L5CX_AMBIENT_RATE_IDX;
+            break;
+        case VL53L5CX_OUTPUT_NB_SPADS_ENABLED:
+            idx = VL53L5CX_SPAD_COUNT_IDX;
+            break;
+        case VL53L5CX_OUTPUT_NB_TARGET_DETECTED:
+            idx = VL53L5CX_NB_TARGET_DETECTED_IDX;
+            break;
+        case VL53L5CX_OUTPUT_SIGNAL_PER_SPAD:
+            idx = VL53L5CX_SIGNAL_RATE_IDX;
+            break;
+        case VL53L5CX_OUTPUT_RANGE_SIGMA_MM:
+            idx = VL53L5CX_RANGE_SIGMA_MM_IDX;
+            break;
+        case VL53L5CX_OUTPUT_DISTANCE_MM:
+            idx = VL53L5CX_DISTANCE_IDX;
+            break;
+        case VL53L5CX_OUTPUT_REFLECTANCE_PERCENT:
+            idx = VL53L5CX_REFLECTANCE_EST_PC_IDX;
+            break;
+        case VL53L5CX_OUTPUT_TARGET_STATUS:
+            idx = VL53L5CX_TARGET_STATUS_IDX;
+            break;
+        case VL53L5CX_OUTPUT_MOTION_INDICATOR:
+            idx = VL53L5CX_MOTION_DETEC_IDX;
+            break;
+        default:
+            idx = 0;
+            break;
+    }
+
+    return idx;
+}
+
+/**
+ * @brief Inner function, not available outside this file. This function gives
+ * the output blocks not disabled at compile time.
+ */
+
+static uint32_t _vl53l5cx_compiled_outputs(void)
+{
+    uint32_t outputs = 0;
+
+#ifndef VL53L5CX_DISABLE_AMBIENT_PER_SPAD
+    outputs |= VL53L5CX_OUTPUT_AMBIENT_PER_SPAD;
+#endif
+#ifndef VL53L5CX_DISABLE_NB_SPADS_ENABLED
+    outputs |= VL53L5CX_OUTPUT_NB_SPADS_ENABLED;
+#endif
+#ifndef VL53L5CX_DISABLE_NB_TARGET_DETECTED
+    outputs |= VL53L5CX_OUTPUT_NB_TARGET_DETECTED;
+#endif
+#ifndef VL53L5CX_DISABLE_SIGNAL_PER_SPAD
+    outputs |= VL53L5CX_OUTPUT_SIGNAL_PER_SPAD;
+#endif
+#ifndef VL53L5CX_DISABLE_RANGE_SIGMA_MM
+    outputs |= VL53L5CX_OUTPUT_RANGE_SIGMA_MM;
+#endif
+#ifndef VL53L5CX_DISABLE_DISTANCE_MM
+    outputs |= VL53L5CX_OUTPUT_DISTANCE_MM;
+#endif
+#ifndef VL53L5CX_DISABLE_REFLECTANCE_PERCENT
+    outputs |= VL53L5CX_OUTPUT_REFLECTANCE_PERCENT;
+#endif
+#ifndef VL53L5CX_DISABLE_TARGET_STATUS
+    outputs |= VL53L5CX_OUTPUT_TARGET_STATUS;
+#endif
+#ifndef VL53L5CX_DISABLE_MOTION_INDICATOR
+    outputs |= VL53L5CX_OUTPUT_MOTION_INDICATOR;
+#endif
+
+    return outputs;
 }
-#endif
 
 uint8_t vl53l5cx_is_alive(
         VL53L5CX_Configuration		*p_dev,
@@ -371,15 +1043,67 @@ uint8_t vl53l5cx_is_alive(
     return status;
 }
 
+/* Scratch of the devices which do not select their own */
+static VL53L5CX_Scratch _vl53l5cx_shared_scratch;
+
+uint8_t vl53l5cx_config_init(
+        VL53L5CX_Configuration		*p_dev)
+{
+    (void)memset(p_dev, 0, sizeof(VL53L5CX_Configuration));
+
+    return vl53l5cx_set_scratch(p_dev, NULL);
+
+} // vl53l5cx_config_init
+
+uint8_t vl53l5cx_set_scratch(
+        VL53L5CX_Configuration		*p_dev,
+        VL53L5CX_Scratch		*p_scratch)
+{
+    if(p_scratch == NULL)
+    {
+        p_scratch = &_vl53l5cx_shared_scratch;
+    }
+
+    p_dev->p_scratch = p_scratch;
+    p_dev->temp_buffer = p_scratch->buffer;
+
+    return VL53L5CX_STATUS_OK;
+
+} // vl53l5cx_set_scratch
+
+uint8_t vl53l5cx_set_calibration(
+        VL53L5CX_Configuration		*p_dev,
+        VL53L5CX_Calibration		*p_calibration)
+{
+    if(p_calibration == NULL)
+    {
+        return VL53L5CX_STATUS_INVALID_PARAM;
+    }
+
+    p_dev->p_calibration = p_calibration;
+
+    /* Xtalk storage is optional, selected afterwards by the xtalk plugin */
+    p_dev->p_xtalk_storage = NULL;
+
+    return VL53L5CX_STATUS_OK;
+
+} // vl53l5cx_set_calibration
+
 uint8_t vl53l5cx_init(
         VL53L5CX_Configuration		*p_dev)
 {
     uint8_t tmp, status = VL53L5CX_STATUS_OK;
-    uint8_t pipe_ctrl[] = {VL53L5CX_NB_TARGET_PER_ZONE, 0x00, 0x01, 0x00};
     uint32_t single_range = 0x01;
 
+    /* Offsets read from the NVM need the calibration storage */
+    if(p_dev->p_calibration == NULL)
+    {
+        return VL53L5CX_STATUS_INVALID_PARAM;
+    }
+
     p_dev->default_xtalk = (uint8_t*)VL53L5CX_DEFAULT_XTALK;
     p_dev->default_configuration = (uint8_t*)VL53L5CX_DEFAULT_CONFIGURATION;
+    p_dev->outputs = _vl53l5cx_compiled_outputs();
 
     /* SW reboot sequence */
     status |= WrByte(&(p_dev->platform), 0x7fff, 0x00);
@@ -482,13 +1206,12 @@ uint8_t vl53l5cx_init(
             VL53L5CX_UI_CMD_STATUS, 0xff, 2);
     status |= VL53L1CX_ReadMulti(&(p_dev->platform), VL53L5CX_UI_CMD_START,
             p_dev->temp_buffer, VL53L5CX_NVM_DATA_SIZE);
-    (void)memcpy(p_dev->offset_data, p_dev->temp_buffer,
+    (void)memcpy(p_dev->p_calibration->offset_data, p_dev->temp_buffer,
             VL53L5CX_OFFSET_BUFFER_SIZE);
     status |= _vl53l5cx_send_offset_data(p_dev, VL53L5CX_RESOLUTION_4X4);
 
-    /* Set default Xtalk shape. Send Xtalk to sensor */
-    (void)memcpy(p_dev->xtalk_data, (uint8_t*)VL53L5CX_DEFAULT_XTALK,
-            VL53L5CX_XTALK_BUFFER_SIZE);
+    /* Set default Xtalk shape, sent from flash. Send Xtalk to sensor */
+    p_dev->p_xtalk_data = p_dev->default_xtalk;
     status |= _vl53l5cx_send_xtalk_data(p_dev, VL53L5CX_RESOLUTION_4X4);
 
     /* Send default configuration to VL53L5CX firmware */
@@ -497,20 +1220,14 @@ uint8_t vl53l5cx_init(
             sizeof(VL53L5CX_DEFAULT_CONFIGURATION));
     status |= _vl53l5cx_poll_for_answer(p_dev, 4, 1,
             VL53L5CX_UI_CMD_STATUS, 0xff, 0x03);
-    status |= vl53l5cx_dci_write_data(p_dev, (uint8_t*)&pipe_ctrl,
-            VL53L5CX_DCI_PIPE_CONTROL, (uint16_t)sizeof(pipe_ctrl));
-#if VL53L5CX_NB_TARGET_PER_ZONE != 1
-    tmp = VL53L5CX_NB_TARGET_PER_ZONE;
-    status |= vl53l5cx_dci_replace_data(p_dev, p_dev->temp_buffer,
-            VL53L5CX_DCI_FW_NB_TARGET, 16,
-            (uint8_t*)&tmp, 1, 0x0C);
-#endif
+    status |= vl53l5cx_set_nb_target_per_zone(p_dev,
+            (uint8_t)VL53L5CX_NB_TARGET_PER_ZONE);
 
     status |= vl53l5cx_dci_write_data(p_dev, (uint8_t*)&single_range,
             VL53L5CX_DCI_SINGLE_RANGE,
             (uint16_t)sizeof(single_range));
 
-#ifdef VL53L5CX_LFT_FILTER
+#ifdef VL53L5CX_LTF_FILTER
     status |= vl53l5cx_get_target_order(p_dev, &p_dev->target_order);
     status |= vl53l5cx_get_resolution(p_dev, &p_dev->resolution);
 #endif
@@ -602,15 +1319,15 @@ uint8_t vl53l5cx_start_ranging(
         VL53L5CX_Configuration		*p_dev)
 {
     uint8_t resolution, status = VL53L5CX_STATUS_OK;
-    uint32_t i;
+    uint32_t i, msize;
     uint32_t header_config[2] = {0, 0};
 
     union Block_header *bh_ptr;
-    uint8_t cmd[] = {0x00, 0x03, 0x00, 0x00};
 
     status |= vl53l5cx_get_resolution(p_dev, &resolution);
+    p_dev->resolution = resolution;
     p_dev->data_read_size = 0;
-    p_dev->streamcount = 255;
+    p_dev->decode_plan_size = 0;
 
     /* Enable mandatory output (meta and common data) */
     uint32_t output_bh_enable[] = {
@@ -633,33 +1350,8 @@ uint8_t vl53l5cx_start_ranging(
         VL53L5CX_TARGET_STATUS_BH,
         VL53L5CX_MOTION_DETECT_BH};
 
-#ifndef VL53L5CX_DISABLE_AMBIENT_PER_SPAD
-    output_bh_enable[0] += (uint32_t)8;
-#endif
-#ifndef VL53L5CX_DISABLE_NB_SPADS_ENABLED
-    output_bh_enable[0] += (uint32_t)16;
-#endif
-#ifndef VL53L5CX_DISABLE_NB_TARGET_DETECTED
-    output_bh_enable[0] += (uint32_t)32;
-#endif
-#ifndef VL53L5CX_DISABLE_SIGNAL_PER_SPAD
-    output_bh_enable[0] += (uint32_t)64;
-#endif
-#ifndef VL53L5CX_DISABLE_RANGE_SIGMA_MM
-    output_bh_enable[0] += (uint32_t)128;
-#endif
-#ifndef VL53L5CX_DISABLE_DISTANCE_MM
-    output_bh_enable[0] += (uint32_t)256;
-#endif
-#ifndef VL53L5CX_DISABLE_REFLECTANCE_PERCENT
-    output_bh_enable[0] += (uint32_t)512;
-#endif
-#ifndef VL53L5CX_DISABLE_TARGET_STATUS
-    output_bh_enable[0] += (uint32_t)1024;
-#endif
-#ifndef VL53L5CX_DISABLE_MOTION_INDICATOR
-    output_bh_enable[0] += (uint32_t)2048;
-#endif
+    /* Enable selected outputs */
+    output_bh_enable[0] |= p_dev->outputs;
 
     /* Update data size */
     for (i = 0; i < (uint32_t)(sizeof(output)/sizeof(uint32_t)); i++)
@@ -682,19 +1374,35 @@ uint8_t vl53l5cx_start_ranging(
             }
             else
             {
-                bh_ptr->size = (uint8_t)(resolution 
-                        * (uint8_t)VL53L5CX_NB_TARGET_PER_ZONE);
+                /* 8x8 with 4 targets is 256 entries, too many for 8 bits */
+                bh_ptr->size = (uint16_t)resolution
+                        * (uint16_t)p_dev->nb_target_per_zone;
             }
-            p_dev->data_read_size += bh_ptr->type * bh_ptr->size;
+            msize = bh_ptr->type * bh_ptr->size;
         }
         else
         {
-            p_dev->data_read_size += bh_ptr->size;
+            msize = bh_ptr->size;
         }
+
+        /* Blocks follow 12 bytes of headers, each one after its own header */
+        _vl53l5cx_add_decode_step(p_dev, (uint16_t)bh_ptr->idx,
+                (uint16_t)(p_dev->data_read_size + (uint32_t)16),
+                (uint16_t)msize);
+
+        p_dev->data_read_size += msize;
         p_dev->data_read_size += (uint32_t)4;
     }
     p_dev->data_read_size += (uint32_t)20;
 
+    /* Frames are read into the temporary buffer, sized by the macros */
+    if (p_dev->data_read_size > (uint32_t)VL53L5CX_TEMPORARY_BUFFER_SIZE)
+    {
+        p_dev->data_read_size = 0;
+        p_dev->decode_plan_size = 0;
+        return status | VL53L5CX_STATUS_INVALID_PARAM;
+    }
+
     status |= vl53l5cx_dci_write_data(p_dev,
             (uint8_t*)&(output), VL53L5CX_DCI_OUTPUT_LIST,
             (uint16_t)sizeof(output));
@@ -710,6 +1418,20 @@ uint8_t vl53l5cx_start_ranging(
             (uint8_t*)&(output_bh_enable), VL53L5CX_DCI_OUTPUT_ENABLES,
             (uint16_t)sizeof(output_bh_enable));
 
+    status |= vl53l5cx_resume_ranging(p_dev);
+
+    return status;
+
+} // vl53l5cx_start_ranging
+
+uint8_t vl53l5cx_resume_ranging(
+        VL53L5CX_Configuration		*p_dev)
+{
+    uint8_t status = VL53L5CX_STATUS_OK;
+    uint8_t cmd[] = {0x00, 0x03, 0x00, 0x00};
+
+    p_dev->streamcount = 255;
+
     /* Start xshut bypass (interrupt mode) */
     status |= WrByte(&(p_dev->platform), 0x7fff, 0x00);
     status |= WrByte(&(p_dev->platform), 0x09, 0x05);
@@ -723,7 +1445,7 @@ uint8_t vl53l5cx_start_ranging(
 
     return status;
 
-} // vl53l5cx_set_power_mode
+} // vl53l5cx_resume_ranging
 
 uint8_t vl53l5cx_stop_ranging(
         VL53L5CX_Configuration		*p_dev)
@@ -772,18 +1494,20 @@ uint8_t vl53l5cx_check_data_ready(
         uint8_t				*p_isReady)
 {
     uint8_t status = VL53L5CX_STATUS_OK;
+    uint8_t frame_header[4];
 
-    status |= VL53L1CX_ReadMulti(&(p_dev->platform), 0x0, p_dev->temp_buffer, 4);
+    /* Polling leaves the frame of any device sharing the scratch intact */
+    status |= VL53L1CX_ReadMulti(&(p_dev->platform), 0x0, frame_header, 4);
 
-    if((p_dev->temp_buffer[0] != p_dev->streamcount)
-            && (p_dev->temp_buffer[0] != (uint8_t)255)
-            && (p_dev->temp_buffer[1] == (uint8_t)0x5)
-            && ((p_dev->temp_buffer[2] & (uint8_t)0x5) == (uint8_t)0x5)
-            && ((p_dev->temp_buffer[3] & (uint8_t)0x10) ==(uint8_t)0x10)
+    if((frame_header[0] != p_dev->streamcount)
+            && (frame_header[0] != (uint8_t)255)
+            && (frame_header[1] == (uint8_t)0x5)
+            && ((frame_header[2] & (uint8_t)0x5) == (uint8_t)0x5)
+            && ((frame_header[3] & (uint8_t)0x10) ==(uint8_t)0x10)
       )
     {
         *p_isReady = (uint8_t)1;
-        p_dev->streamcount = p_dev->temp_buffer[0];
+        p_dev->streamcount = frame_header[0];
     }
     else
     {
@@ -796,153 +1520,618 @@ uint8_t vl53l5cx_check_data_ready(
 
 uint8_t vl53l5cx_get_ranging_data(
         VL53L5CX_Configuration		*p_dev,
-        VL53L5CX_ResultsData		*p_results)
+        VL53L5CX_ResultsData		*p_results)
+{
+    uint8_t status = VL53L5CX_STATUS_OK;
+    uint32_t i, j;
+
+    status |= VL53L1CX_ReadMulti(&(p_dev->platform), 0x0,
+            p_dev->temp_buffer, p_dev->data_read_size);
+    p_dev->p_scratch->p_frame_owner = NULL;
+
+    p_results->nb_zones = p_dev->resolution;
+    p_results->nb_target_per_zone = p_dev->nb_target_per_zone;
+
+    /* Decode and convert data into their real format in one pass, using the
+     * plan computed at start. If there is no plan, or if the frame does not
+     * match it, swap the frame and walk the block headers instead */
+    if((p_dev->decode_plan_size == (uint8_t)0)
+            || (_vl53l5cx_decode_plan(p_dev, p_results) != VL53L5CX_STATUS_OK))
+    {
+        vl53l5cx_swap_buffer(p_dev->temp_buffer,
+                (uint16_t)p_dev->data_read_size);
+        _vl53l5cx_decode_walk(p_dev, p_results);
+
+        /* Set target status to 255 if no target is detected for this zone */
+#ifndef VL53L5CX_DISABLE_NB_TARGET_DETECTED
+        for(i = 0; i < (uint32_t)p_dev->resolution; i++)
+        {
+            if(((p_dev->outputs & VL53L5CX_OUTPUT_NB_TARGET_DETECTED) != 0U)
+                    && (p_results->nb_target_detected[i] == (uint8_t)0)){
+                for(j = 0; j < (uint32_t)
+                        p_dev->nb_target_per_zone; j++)
+                {
+#ifndef VL53L5CX_DISABLE_TARGET_STATUS
+                    p_results->target_status
+                        [((uint32_t)p_dev->nb_target_per_zone
+                                *(uint32_t)i) + j]=(uint8_t)255;
+#endif
+                }
+            }
+        }
+#endif
+    }
+
+#ifdef VL53L5CX_LTF_FILTER
+    // Discard false tarets of the tail
+    status |= _vl53l5cx_remove_false_target(p_dev,
+            p_results->nb_target_detected, p_results->target_status,
+            p_results->distance_mm, p_results->signal_per_spad);
+#endif
+
+    return status;
+
+} // vl53l5cx_get_ranging_data
+
+uint8_t vl53l5cx_get_raw_data(
+        VL53L5CX_Configuration		*p_dev,
+        VL53L5CX_ResultsData		*p_results)
+{
+    uint8_t status = VL53L5CX_STATUS_OK;
+
+    status |= VL53L1CX_ReadMulti(&(p_dev->platform), 0x0,
+            p_dev->temp_buffer, p_dev->data_read_size);
+    p_dev->p_scratch->p_frame_owner = p_dev;
+
+    if(p_results != NULL)
+    {
+        p_results->nb_zones = p_dev->resolution;
+        p_results->nb_target_per_zone = p_dev->nb_target_per_zone;
+    }
+
+    return status;
+
+} // vl53l5cx_get_raw_data
+
+uint8_t vl53l5cx_decode_field(
+        VL53L5CX_Configuration		*p_dev,
+        VL53L5CX_ResultsData		*p_results,
+        uint32_t			output)
+{
+    uint8_t i, status = VL53L5CX_STATUS_ERROR;
+    uint16_t idx = _vl53l5cx_output_idx(output);
+
+    /* Another device, or a DCI operation, used the scratch since the read */
+    if(p_dev->p_scratch->p_frame_owner != p_dev)
+    {
+        idx = 0;
+    }
+
+#ifndef VL53L5CX_DISABLE_NB_TARGET_DETECTED
+    /* Target status is set to 255 using the number of targets */
+    if((output == VL53L5CX_OUTPUT_TARGET_STATUS)
+            && (p_dev->outputs & VL53L5CX_OUTPUT_NB_TARGET_DETECTED))
+    {
+        (void)vl53l5cx_decode_field(p_dev, p_results,
+                VL53L5CX_OUTPUT_NB_TARGET_DETECTED);
+    }
+#endif
+
+    for(i = 0; i < p_dev->decode_plan_size; i++)
+    {
+        if((idx != (uint16_t)0) && (p_dev->decode_plan[i].idx == idx))
+        {
+            status = _vl53l5cx_decode_step(p_dev, p_results,
+                    &(p_dev->decode_plan[i]));
+            break;
+        }
+    }
+
+#ifdef VL53L5CX_LTF_FILTER
+    /* Discard false targets of the tail, as vl53l5cx_get_ranging_data()
+     * does, reading distances and signals from the raw frame */
+    if((output == VL53L5CX_OUTPUT_TARGET_STATUS)
+            && (status == VL53L5CX_STATUS_OK))
+    {
+        status |= _vl53l5cx_remove_false_target(p_dev,
+                p_results->nb_target_detected, p_results->target_status,
+                NULL, NULL);
+    }
+#endif
+
+    return status;
+
+} // vl53l5cx_decode_field
+
+/**
+ * @brief Inner function, not available outside this file. This function reads
+ * the two 16 bits elements of a word in firmware format.
+ */
+
+static inline void _vl53l5cx_raw_u16_pair(
+        const uint8_t			*p_src,
+        uint16_t			*p_pair)
+{
+    uint32_t word = _vl53l5cx_swap_word(p_src);
+
+    (void)memcpy(p_pair, &word, 4);
+}
+
+/**
+ * @brief Inner function, not available outside this file. This function
+ * converts the frame in the temporary buffer to float or fixed point arrays
+ * (one of p_float or p_fixed is NULL), in a single pass per block.
+ */
+
+static uint8_t _vl53l5cx_decode_units(
+        VL53L5CX_Configuration		*p_dev,
+        VL53L5CX_ResultsFloat		*p_float,
+        VL53L5CX_ResultsFixed		*p_fixed)
+{
+    uint8_t i, status = VL53L5CX_STATUS_OK;
+    uint16_t j, k;
+    const VL53L5CX_DecodeStep *p_step;
+    const uint8_t *p_src;
+    union Block_header bh;
+    uint32_t word;
+    uint16_t pair[2];
+    uint8_t *p_u8;
+    float *p_f;
+    int32_t *p_q;
+
+    for(i = 0; (i < p_dev->decode_plan_size)
+            && (status == VL53L5CX_STATUS_OK); i++)
+    {
+        p_step = &(p_dev->decode_plan[i]);
+        p_src = &(p_dev->temp_buffer[p_step->src_offset]);
+
+        bh.bytes = _vl53l5cx_swap_word(p_src - 4);
+        if(bh.idx != p_step->idx)
+        {
+            status = VL53L5CX_STATUS_ERROR;
+            break;
+        }
+
+        p_u8 = NULL;
+        p_f = NULL;
+        p_q = NULL;
+
+        switch(p_step->idx){
+#ifndef VL53L5CX_DISABLE_NB_TARGET_DETECTED
+            case VL53L5CX_NB_TARGET_DETECTED_IDX:
+                p_u8 = (p_float != NULL) ? p_float->nb_target_detected
+                    : p_fixed->nb_target_detected;
+                break;
+#endif
+#ifndef VL53L5CX_DISABLE_TARGET_STATUS
+            case VL53L5CX_TARGET_STATUS_IDX:
+                p_u8 = (p_float != NULL) ? p_float->target_status
+                    : p_fixed->target_status;
+                break;
+#endif
+#ifndef VL53L5CX_DISABLE_AMBIENT_PER_SPAD
+            case VL53L5CX_AMBIENT_RATE_IDX:
+                p_f = (p_float != NULL) ? p_float->ambient_kcps : NULL;
+                p_q = (p_fixed != NULL) ? p_fixed->ambient_kcps_q16 : NULL;
+                break;
+#endif
+#ifndef VL53L5CX_DISABLE_SIGNAL_PER_SPAD
+            case VL53L5CX_SIGNAL_RATE_IDX:
+                p_f = (p_float != NULL) ? p_float->signal_kcps : NULL;
+                p_q = (p_fixed != NULL) ? p_fixed->signal_kcps_q16 : NULL;
+                break;
+#endif
+#ifndef VL53L5CX_DISABLE_RANGE_SIGMA_MM
+            case VL53L5CX_RANGE_SIGMA_MM_IDX:
+                p_f = (p_float != NULL) ? p_float->range_sigma_m : NULL;
+                p_q = (p_fixed != NULL) ? p_fixed->range_sigma_m_q16 : NULL;
+                break;
+#endif
+#ifndef VL53L5CX_DISABLE_DISTANCE_MM
+            case VL53L5CX_DISTANCE_IDX:
+                p_f = (p_float != NULL) ? p_float->distance_m : NULL;
+                p_q = (p_fixed != NULL) ? p_fixed->distance_m_q16 : NULL;
+                break;
+#endif
+            default:
+                break;
+        }
+
+        /* Byte arrays only need the swap */
+        if(p_u8 != NULL)
+        {
+            _vl53l5cx_swap_convert(p_u8, p_src, p_step->size,
+                    VL53L5CX_CONVERSION_NONE);
+        }
+
+        /* Rates are kcps * 2048 */
+        else if((p_step->conversion == VL53L5CX_CONVERSION_KCPS)
+                && (p_f != NULL))
+        {
+            for(j = 0; j < (p_step->size / (uint16_t)4); j++)
+            {
+                word = _vl53l5cx_swap_word(&(p_src[4 * j]));
+                p_f[j] = (float)word * (1.0f / 2048.0f);
+            }
+        }
+        else if((p_step->conversion == VL53L5CX_CONVERSION_KCPS)
+                && (p_q != NULL))
+        {
+            for(j = 0; j < (p_step->size / (uint16_t)4); j++)
+            {
+                word = _vl53l5cx_swap_word(&(p_src[4 * j]));
+                p_q[j] = (word >= (uint32_t)0x04000000) ? (int32_t)0x7FFFFFFF
+                    : (int32_t)(word << 5);
+            }
+        }
+
+        /* Sigmas are mm * 128 */
+        else if((p_step->conversion == VL53L5CX_CONVERSION_SIGMA)
+                && (p_f != NULL))
+        {
+            for(j = 0; j < (p_step->size / (uint16_t)2); j += 2)
+            {
+                _vl53l5cx_raw_u16_pair(&(p_src[2 * j]), pair);
+                p_f[j] = (float)pair[0] * (1.0f / 128000.0f);
+                p_f[j + 1] = (float)pair[1] * (1.0f / 128000.0f);
+            }
+        }
+        else if((p_step->conversion == VL53L5CX_CONVERSION_SIGMA)
+                && (p_q != NULL))
+        {
+            for(j = 0; j < (p_step->size / (uint16_t)2); j += 2)
+            {
+                _vl53l5cx_raw_u16_pair(&(p_src[2 * j]), pair);
+                p_q[j] = ((int32_t)pair[0] * 512) / 1000;
+                p_q[j + 1] = ((int32_t)pair[1] * 512) / 1000;
+            }
+        }
+
+        /* Distances are mm * 4, clamped to 0 */
+        else if((p_step->conversion == VL53L5CX_CONVERSION_DISTANCE)
+                && (p_f != NULL))
+        {
+            for(j = 0; j < (p_step->size / (uint16_t)2); j += 2)
+            {
+                _vl53l5cx_raw_u16_pair(&(p_src[2 * j]), pair);
+                for(k = 0; k < (uint16_t)2; k++)
+                {
+                    p_f[j + k] = ((int16_t)pair[k] < 0) ? 0.0f
+                        : (float)(int16_t)pair[k] * (1.0f / 4000.0f);
+                }
+            }
+        }
+        else if((p_step->conversion == VL53L5CX_CONVERSION_DISTANCE)
+                && (p_q != NULL))
+        {
+            for(j = 0; j < (p_step->size / (uint16_t)2); j += 2)
+            {
+                _vl53l5cx_raw_u16_pair(&(p_src[2 * j]), pair);
+                for(k = 0; k < (uint16_t)2; k++)
+                {
+                    p_q[j + k] = ((int16_t)pair[k] < 0) ? 0
+                        : ((int32_t)(int16_t)pair[k] * 16384) / 1000;
+                }
+            }
+        }
+        else
+        {
+            /* Block not available in these layouts */
+        }
+    }
+
+#ifndef VL53L5CX_DISABLE_NB_TARGET_DETECTED
+#ifndef VL53L5CX_DISABLE_TARGET_STATUS
+    /* Set target status to 255 if no target is detected for this zone */
+    p_u8 = (p_float != NULL) ? p_float->nb_target_detected
+        : p_fixed->nb_target_detected;
+    if((status == VL53L5CX_STATUS_OK)
+            && (p_dev->outputs & VL53L5CX_OUTPUT_NB_TARGET_DETECTED))
+    {
+        for(j = 0; j < (uint16_t)p_dev->resolution; j++)
+        {
+            if(p_u8[j] == (uint8_t)0)
+            {
+                for(k = 0; k < (uint16_t)p_dev->nb_target_per_zone; k++)
+                {
+                    ((p_float != NULL) ? p_float->target_status
+                     : p_fixed->target_status)
+                        [(j * (uint16_t)p_dev->nb_target_per_zone) + k]
+                        = (uint8_t)255;
+                }
+            }
+        }
+    }
+#endif
+#endif
+
+    return status;
+}
+
+uint8_t vl53l5cx_get_ranging_data_float(
+        VL53L5CX_Configuration		*p_dev,
+        VL53L5CX_ResultsFloat		*p_results)
+{
+    uint8_t status = VL53L5CX_STATUS_OK;
+
+    status |= VL53L1CX_ReadMulti(&(p_dev->platform), 0x0,
+            p_dev->temp_buffer, p_dev->data_read_size);
+    p_dev->p_scratch->p_frame_owner = NULL;
+
+    p_results->nb_zones = p_dev->resolution;
+    p_results->nb_target_per_zone = p_dev->nb_target_per_zone;
+
+    status |= _vl53l5cx_decode_units(p_dev, p_results, NULL);
+
+#ifdef VL53L5CX_LTF_FILTER
+    /* Discard false targets of the tail, as vl53l5cx_get_ranging_data()
+     * does, reading distances and signals from the raw frame */
+    status |= _vl53l5cx_remove_false_target(p_dev,
+            p_results->nb_target_detected, p_results->target_status,
+            NULL, NULL);
+#endif
+
+    return status;
+
+} // vl53l5cx_get_ranging_data_float
+
+uint8_t vl53l5cx_get_ranging_data_fixed(
+        VL53L5CX_Configuration		*p_dev,
+        VL53L5CX_ResultsFixed		*p_results)
 {
     uint8_t status = VL53L5CX_STATUS_OK;
-    union Block_header *bh_ptr;
-    uint32_t i, j, msize;
 
     status |= VL53L1CX_ReadMulti(&(p_dev->platform), 0x0,
             p_dev->temp_buffer, p_dev->data_read_size);
+    p_dev->p_scratch->p_frame_owner = NULL;
 
-    SwapBuffer(p_dev->temp_buffer, (uint16_t)p_dev->data_read_size);
+    p_results->nb_zones = p_dev->resolution;
+    p_results->nb_target_per_zone = p_dev->nb_target_per_zone;
 
+    status |= _vl53l5cx_decode_units(p_dev, NULL, p_results);
 
-    /* Start conversion at position 16 to avoid headers */
-    for (i = (uint32_t)16; i 
-            < (uint32_t)p_dev->data_read_size; i+=(uint32_t)4)
+#ifdef VL53L5CX_LTF_FILTER
+    /* Discard false targets of the tail, as vl53l5cx_get_ranging_data()
+     * does, reading distances and signals from the raw frame */
+    status |= _vl53l5cx_remove_false_target(p_dev,
+            p_results->nb_target_detected, p_results->target_status,
+            NULL, NULL);
+#endif
+
+    return status;
+
+} // vl53l5cx_get_ranging_data_fixed
+
+/**
+ * @brief Inner function, not available outside this file. This function
+ * converts the 4x4 frame in the temporary buffer to VL53L5CX_Results4x4, in a
+ * single pass per block. Only the rates are narrowed, other blocks keep the
+ * width of VL53L5CX_ResultsData.
+ */
+
+static uint8_t _vl53l5cx_decode_4x4(
+        VL53L5CX_Configuration		*p_dev,
+        VL53L5CX_Results4x4		*p_results)
+{
+    uint8_t i, status = VL53L5CX_STATUS_OK;
+    uint16_t j, k;
+    const VL53L5CX_DecodeStep *p_step;
+    const uint8_t *p_src;
+    union Block_header bh;
+    uint32_t word;
+    uint8_t *p_dst;
+    uint16_t *p_rate;
+
+    for(i = 0; i < p_dev->decode_plan_size; i++)
     {
-        bh_ptr = (union Block_header *)&(p_dev->temp_buffer[i]);
-        if ((bh_ptr->type > (uint32_t)0x1) 
-                && (bh_ptr->type < (uint32_t)0xd))
-        {
-            msize = bh_ptr->type * bh_ptr->size;
-        }
-        else
+        p_step = &(p_dev->decode_plan[i]);
+        p_src = &(p_dev->temp_buffer[p_step->src_offset]);
+
+        bh.bytes = _vl53l5cx_swap_word(p_src - 4);
+        if(bh.idx != p_step->idx)
         {
-            msize = bh_ptr->size;
+            status = VL53L5CX_STATUS_ERROR;
+            break;
         }
 
-        switch(bh_ptr->idx){
-#ifndef VL53L5CX_DISABLE_AMBIENT_PER_SPAD
-            case VL53L5CX_AMBIENT_RATE_IDX:
-                (void)memcpy(p_results->ambient_per_spad,
-                        &(p_dev->temp_buffer[i + (uint32_t)4]), msize);
+        p_dst = NULL;
+        p_rate = NULL;
+
+        switch(p_step->idx){
+#ifndef VL53L5CX_DISABLE_NB_TARGET_DETECTED
+            case VL53L5CX_NB_TARGET_DETECTED_IDX:
+                p_dst = p_results->nb_target_detected;
                 break;
 #endif
 #ifndef VL53L5CX_DISABLE_NB_SPADS_ENABLED
             case VL53L5CX_SPAD_COUNT_IDX:
-                (void)memcpy(p_results->nb_spads_enabled,
-                        &(p_dev->temp_buffer[i + (uint32_t)4]), msize);
+                p_dst = (uint8_t*)p_results->nb_spads_enabled;
                 break;
 #endif
-#ifndef VL53L5CX_DISABLE_NB_TARGET_DETECTED
-            case VL53L5CX_NB_TARGET_DETECTED_IDX:
-                (void)memcpy(p_results->nb_target_detected,
-                        &(p_dev->temp_buffer[i + (uint32_t)4]), msize);
+#ifndef VL53L5CX_DISABLE_AMBIENT_PER_SPAD
+            case VL53L5CX_AMBIENT_RATE_IDX:
+                p_rate = p_results->ambient_per_spad;
                 break;
 #endif
 #ifndef VL53L5CX_DISABLE_SIGNAL_PER_SPAD
             case VL53L5CX_SIGNAL_RATE_IDX:
-                (void)memcpy(p_results->signal_per_spad,
-                        &(p_dev->temp_buffer[i + (uint32_t)4]), msize);
+                p_rate = p_results->signal_per_spad;
                 break;
 #endif
 #ifndef VL53L5CX_DISABLE_RANGE_SIGMA_MM
             case VL53L5CX_RANGE_SIGMA_MM_IDX:
-                (void)memcpy(p_results->range_sigma_mm,
-                        &(p_dev->temp_buffer[i + (uint32_t)4]), msize);
+                p_dst = (uint8_t*)p_results->range_sigma_mm;
                 break;
 #endif
 #ifndef VL53L5CX_DISABLE_DISTANCE_MM
             case VL53L5CX_DISTANCE_IDX:
-                (void)memcpy(p_results->distance_mm,
-                        &(p_dev->temp_buffer[i + (uint32_t)4]), msize);
+                p_dst = (uint8_t*)p_results->distance_mm;
                 break;
 #endif
 #ifndef VL53L5CX_DISABLE_REFLECTANCE_PERCENT
             case VL53L5CX_REFLECTANCE_EST_PC_IDX:
-                (void)memcpy(p_results->reflectance,
-                        &(p_dev->temp_buffer[i + (uint32_t)4]), msize);
+                p_dst = p_results->reflectance;
                 break;
 #endif
 #ifndef VL53L5CX_DISABLE_TARGET_STATUS
             case VL53L5CX_TARGET_STATUS_IDX:
-                (void)memcpy(p_results->target_status,
-                        &(p_dev->temp_buffer[i + (uint32_t)4]), msize);
-                break;
-#endif
-#ifndef VL53L5CX_DISABLE_MOTION_INDICATOR
-            case VL53L5CX_MOTION_DETEC_IDX:
-                (void)memcpy(&p_results->motion_indicator,
-                        &(p_dev->temp_buffer[i + (uint32_t)4]), msize);
+                p_dst = p_results->target_status;
                 break;
 #endif
             default:
                 break;
         }
-        i += msize;
-    }
 
-    /* Convert data into their real format */
-#ifndef VL53L5CX_DISABLE_AMBIENT_PER_SPAD
-    for(i = 0; i < (uint32_t)VL53L5CX_RESOLUTION_8X8; i++)
-    {
-        p_results->ambient_per_spad[i] /= (uint32_t)2048;
-    }
-#endif
+        /* Same width as VL53L5CX_ResultsData */
+        if(p_dst != NULL)
+        {
+            _vl53l5cx_swap_convert(p_dst, p_src, p_step->size,
+                    p_step->conversion);
+        }
 
-    for(i = 0; i < (uint32_t)(VL53L5CX_RESOLUTION_8X8
-                *VL53L5CX_NB_TARGET_PER_ZONE); i++)
-    {
-#ifndef VL53L5CX_DISABLE_DISTANCE_MM
-        p_results->distance_mm[i] /= 4;
-        if(p_results->distance_mm[i] < 0)
+        /* Rates are kcps * 2048, saturated to 16 bits */
+        else if(p_rate != NULL)
         {
-            p_results->distance_mm[i] = 0;
+            for(j = 0; j < (p_step->size / (uint16_t)4); j++)
+            {
+                word = _vl53l5cx_swap_word(&(p_src[4 * j])) / (uint32_t)2048;
+                p_rate[j] = (word > (uint32_t)0xFFFF) ? (uint16_t)0xFFFF
+                    : (uint16_t)word;
+            }
+        }
+        else
+        {
+            /* Block not available in this layout */
         }
-#endif
-#ifndef VL53L5CX_DISABLE_RANGE_SIGMA_MM
-        p_results->range_sigma_mm[i] /= (uint16_t)128;
-#endif
-#ifndef VL53L5CX_DISABLE_SIGNAL_PER_SPAD
-        p_results->signal_per_spad[i] /= (uint32_t)2048;
-#endif
     }
 
-    /* Set target status to 255 if no target is detected for this zone */
 #ifndef VL53L5CX_DISABLE_NB_TARGET_DETECTED
-    for(i = 0; i < (uint32_t)VL53L5CX_RESOLUTION_8X8; i++)
+#ifndef VL53L5CX_DISABLE_TARGET_STATUS
+    /* Set target status to 255 if no target is detected for this zone */
+    if((status == VL53L5CX_STATUS_OK)
+            && (p_dev->outputs & VL53L5CX_OUTPUT_NB_TARGET_DETECTED))
     {
-        if(p_results->nb_target_detected[i] == (uint8_t)0){
-            for(j = 0; j < (uint32_t)
-                    VL53L5CX_NB_TARGET_PER_ZONE; j++)
+        for(j = 0; j < (uint16_t)VL53L5CX_RESOLUTION_4X4; j++)
+        {
+            if(p_results->nb_target_detected[j] == (uint8_t)0)
             {
-#ifndef VL53L5CX_DISABLE_TARGET_STATUS
-                p_results->target_status
-                    [((uint32_t)VL53L5CX_NB_TARGET_PER_ZONE
-                            *(uint32_t)i) + j]=(uint8_t)255;
-#endif
+                for(k = 0; k < (uint16_t)p_dev->nb_target_per_zone; k++)
+                {
+                    p_results->target_status
+                        [(j * (uint16_t)p_dev->nb_target_per_zone) + k]
+                        = (uint8_t)255;
+                }
             }
         }
     }
+#endif
 #endif
 
-#ifndef VL53L5CX_DISABLE_MOTION_INDICATOR
-    for(i = 0; i < (uint32_t)32; i++)
+    (void)k;
+
+    return status;
+}
+
+uint8_t vl53l5cx_get_ranging_data_4x4(
+        VL53L5CX_Configuration		*p_dev,
+        VL53L5CX_Results4x4		*p_results)
+{
+    uint8_t status = VL53L5CX_STATUS_OK;
+
+    /* The arrays only hold 16 zones */
+    if(p_dev->resolution != VL53L5CX_RESOLUTION_4X4)
     {
-        p_results->motion_indicator.motion[i] /= (uint32_t)65535;
+        return VL53L5CX_STATUS_INVALID_PARAM;
     }
-#endif
+
+    status |= VL53L1CX_ReadMulti(&(p_dev->platform), 0x0,
+            p_dev->temp_buffer, p_dev->data_read_size);
+    p_dev->p_scratch->p_frame_owner = NULL;
+
+    p_results->nb_target_per_zone = p_dev->nb_target_per_zone;
+
+    status |= _vl53l5cx_decode_4x4(p_dev, p_results);
 
 #ifdef VL53L5CX_LTF_FILTER
-    // Discard false tarets of the tail
-    status |= _vl53l5cx_remove_false_target(p_dev, p_results);
+    /* Discard false targets of the tail, as vl53l5cx_get_ranging_data()
+     * does, reading distances and signals from the raw frame */
+    status |= _vl53l5cx_remove_false_target(p_dev,
+            p_results->nb_target_detected, p_results->target_status,
+            NULL, NULL);
 #endif
 
     return status;
 
-} // vl53l5cx_get_ranging_data
+} // vl53l5cx_get_ranging_data_4x4
+
+uint8_t vl53l5cx_set_outputs(
+        VL53L5CX_Configuration		*p_dev,
+        uint32_t			outputs)
+{
+    uint8_t status = VL53L5CX_STATUS_OK;
+
+    if((outputs & ~VL53L5CX_OUTPUT_ALL) != (uint32_t)0)
+    {
+        status = VL53L5CX_STATUS_INVALID_PARAM;
+    }
+    else
+    {
+        p_dev->outputs = outputs & _vl53l5cx_compiled_outputs();
+    }
+
+    return status;
+
+} // vl53l5cx_set_outputs
+
+uint8_t vl53l5cx_get_outputs(
+        VL53L5CX_Configuration		*p_dev,
+        uint32_t			*p_outputs)
+{
+    *p_outputs = p_dev->outputs;
+
+    return VL53L5CX_STATUS_OK;
+
+} // vl53l5cx_get_outputs
+
+uint8_t vl53l5cx_set_nb_target_per_zone(
+        VL53L5CX_Configuration		*p_dev,
+        uint8_t				nb_target_per_zone)
+{
+    uint8_t status = VL53L5CX_STATUS_OK;
+    uint8_t pipe_ctrl[] = {nb_target_per_zone, 0x00, 0x01, 0x00};
+
+    if((nb_target_per_zone < (uint8_t)1)
+            || (nb_target_per_zone > (uint8_t)VL53L5CX_NB_TARGET_PER_ZONE))
+    {
+        status = VL53L5CX_STATUS_INVALID_PARAM;
+    }
+    else
+    {
+        status |= vl53l5cx_dci_write_data(p_dev, (uint8_t*)&pipe_ctrl,
+                VL53L5CX_DCI_PIPE_CONTROL, (uint16_t)sizeof(pipe_ctrl));
+        status |= vl53l5cx_dci_replace_data(p_dev, p_dev->temp_buffer,
+                VL53L5CX_DCI_FW_NB_TARGET, 16,
+                (uint8_t*)&nb_target_per_zone, 1, 0x0C);
+
+        if(status == VL53L5CX_STATUS_OK)
+        {
+            p_dev->nb_target_per_zone = nb_target_per_zone;
+        }
+    }
+
+    return status;
+
+} // vl53l5cx_set_nb_target_per_zone
+
+uint8_t vl53l5cx_get_nb_target_per_zone(
+        VL53L5CX_Configuration		*p_dev,
+        uint8_t				*p_nb_target_per_zone)
+{
+    *p_nb_target_per_zone = p_dev->nb_target_per_zone;
+
+    return VL53L5CX_STATUS_OK;
+
+} // vl53l5cx_get_nb_target_per_zone
 
 uint8_t vl53l5cx_get_resolution(
         VL53L5CX_Configuration		*p_dev,
@@ -1022,10 +2211,8 @@ uint8_t vl53l5cx_set_resolution(
     status |= _vl53l5cx_send_offset_data(p_dev, resolution);
     status |= _vl53l5cx_send_xtalk_data(p_dev, resolution);
 
-#ifdef VL53L5CX_LTF_FILTER
     if (status == VL53L5CX_STATUS_OK)
         p_dev->resolution = resolution;
-#endif
 
     return status;
 
@@ -1275,7 +2462,7 @@ uint8_t vl53l5cx_dci_read_data(
 	/* Read new data sent (4 bytes header + data_size + 8 bytes footer) */
 		status |= VL53L1CX_ReadMulti(&(p_dev->platform), VL53L5CX_UI_CMD_START,
 			p_dev->temp_buffer, rd_size);
-		SwapBuffer(p_dev->temp_buffer, data_size + (uint16_t)12);
+		vl53l5cx_swap_buffer(p_dev->temp_buffer, data_size + (uint16_t)12);
 
 	/* Copy data from FW into input structure (-4 bytes to remove header) */
 		for(i = 0 ; i < (int16_t)data_size;i++){
@@ -1294,6 +2481,23 @@ uint8_t vl53l5cx_dci_write_data(
 		uint16_t			data_size)
 {
 	uint8_t status = VL53L5CX_STATUS_OK;
+
+	/* Convert data from structure to FW format, and back once sent */
+	vl53l5cx_swap_buffer(data, data_size);
+	status |= vl53l5cx_dci_write_wire_data(p_dev, data, index, data_size);
+	vl53l5cx_swap_buffer(data, data_size);
+
+	return status;
+
+} // vl53l5cx_dci_write_data
+
+uint8_t vl53l5cx_dci_write_wire_data(
+		VL53L5CX_Configuration		*p_dev,
+		const uint8_t			*data,
+		uint32_t			index,
+		uint16_t			data_size)
+{
+	uint8_t status = VL53L5CX_STATUS_OK;
 	int16_t i;
 
 	uint8_t headers[] = {0x00, 0x00, 0x00, 0x00};
@@ -1317,8 +2521,7 @@ uint8_t vl53l5cx_dci_write_data(
 		headers[2] = (uint8_t)(((data_size & (uint16_t)0xff0) >> 4));
 		headers[3] = (uint8_t)((data_size & (uint16_t)0xf) << 4);
 
-	/* Copy data from structure to FW format (+4 bytes to add header) */
-		SwapBuffer(data, data_size);
+	/* Copy data (+4 bytes to add header); data may be the temp buffer */
 		for(i = (int16_t)data_size - (int16_t)1 ; i >= 0; i--)
 		{
 			p_dev->temp_buffer[i + 4] = data[i];
@@ -1335,13 +2538,11 @@ uint8_t vl53l5cx_dci_write_data(
 			(uint32_t)((uint32_t)data_size + (uint32_t)12));
 		status |= _vl53l5cx_poll_for_answer(p_dev, 4, 1,
 			VL53L5CX_UI_CMD_STATUS, 0xff, 0x03);
-
-		SwapBuffer(data, data_size);
 	}
 
 	return status;
 
-} // vl53l5cx_dci_write_data
+} // vl53l5cx_dci_write_wire_data
 
 uint8_t vl53l5cx_dci_replace_data(
 		VL53L5CX_Configuration		*p_dev,
@@ -1361,3 +2562,258 @@ uint8_t vl53l5cx_dci_replace_data(
 	return status;
 
 } // vl53l5cx_dci_replace_data
+
+uint8_t vl53l5cx_get_profile(
+        VL53L5CX_Configuration		*p_dev,
+        VL53L5CX_Profile		*p_profile)
+{
+    uint8_t status = VL53L5CX_STATUS_OK;
+
+    status |= vl53l5cx_dci_read_data(p_dev, p_profile->zone_config,
+            VL53L5CX_DCI_ZONE_CONFIG, sizeof(p_profile->zone_config));
+    status |= vl53l5cx_dci_read_data(p_dev, p_profile->dss_config,
+            VL53L5CX_DCI_DSS_CONFIG, sizeof(p_profile->dss_config));
+    status |= vl53l5cx_dci_read_data(p_dev, p_profile->freq_hz,
+            VL53L5CX_DCI_FREQ_HZ, sizeof(p_profile->freq_hz));
+    status |= vl53l5cx_dci_read_data(p_dev, p_profile->int_time,
+            VL53L5CX_DCI_INT_TIME, sizeof(p_profile->int_time));
+    status |= vl53l5cx_dci_read_data(p_dev, p_profile->ranging_mode,
+            VL53L5CX_DCI_RANGING_MODE, sizeof(p_profile->ranging_mode));
+    status |= vl53l5cx_dci_read_data(p_dev, p_profile->single_range,
+            VL53L5CX_DCI_SINGLE_RANGE, sizeof(p_profile->single_range));
+    status |= vl53l5cx_dci_read_data(p_dev, p_profile->target_order,
+            VL53L5CX_DCI_TARGET_ORDER, sizeof(p_profile->target_order));
+    status |= vl53l5cx_dci_read_data(p_dev, p_profile->sharpener,
+            VL53L5CX_DCI_SHARPENER, sizeof(p_profile->sharpener));
+
+    p_profile->resolution =
+        p_profile->zone_config[0x00]*p_profile->zone_config[0x01];
+
+    return status;
+
+} // vl53l5cx_get_profile
+
+uint8_t vl53l5cx_profile_set_resolution(
+        VL53L5CX_Profile		*p_profile,
+        uint8_t				resolution)
+{
+    uint8_t status = VL53L5CX_STATUS_OK;
+
+    /* Same fields as vl53l5cx_set_resolution() */
+    switch(resolution){
+        case VL53L5CX_RESOLUTION_4X4:
+            p_profile->dss_config[0x04] = 64;
+            p_profile->dss_config[0x06] = 64;
+            p_profile->dss_config[0x09] = 4;
+            p_profile->zone_config[0x00] = 4;
+            p_profile->zone_config[0x01] = 4;
+            p_profile->zone_config[0x04] = 8;
+            p_profile->zone_config[0x05] = 8;
+            p_profile->resolution = resolution;
+            break;
+
+        case VL53L5CX_RESOLUTION_8X8:
+            p_profile->dss_config[0x04] = 16;
+            p_profile->dss_config[0x06] = 16;
+            p_profile->dss_config[0x09] = 1;
+            p_profile->zone_config[0x00] = 8;
+            p_profile->zone_config[0x01] = 8;
+            p_profile->zone_config[0x04] = 4;
+            p_profile->zone_config[0x05] = 4;
+            p_profile->resolution = resolution;
+            break;
+
+        default:
+            status = VL53L5CX_STATUS_INVALID_PARAM;
+            break;
+    }
+
+    return status;
+
+} // vl53l5cx_profile_set_resolution
+
+uint8_t vl53l5cx_profile_set_ranging_frequency_hz(
+        VL53L5CX_Profile		*p_profile,
+        uint8_t				frequency_hz)
+{
+    p_profile->freq_hz[0x01] = frequency_hz;
+
+    return VL53L5CX_STATUS_OK;
+
+} // vl53l5cx_profile_set_ranging_frequency_hz
+
+uint8_t vl53l5cx_profile_set_integration_time_ms(
+        VL53L5CX_Profile		*p_profile,
+        uint32_t			integration_time_ms)
+{
+    uint8_t status = VL53L5CX_STATUS_OK;
+    uint32_t integration = integration_time_ms;
+
+    /* Integration time must be between 2ms and 1000ms */
+    if((integration < (uint32_t)2)
+            || (integration > (uint32_t)1000))
+    {
+        status |= VL53L5CX_STATUS_INVALID_PARAM;
+    }
+    else
+    {
+        integration *= (uint32_t)1000;
+        (void)memcpy(&(p_profile->int_time[0x00]), &integration, 4);
+    }
+
+    return status;
+
+} // vl53l5cx_profile_set_integration_time_ms
+
+uint8_t vl53l5cx_profile_set_sharpener_percent(
+        VL53L5CX_Profile		*p_profile,
+        uint8_t				sharpener_percent)
+{
+    uint8_t status = VL53L5CX_STATUS_OK;
+
+    if(sharpener_percent >= (uint8_t)100)
+    {
+        status |= VL53L5CX_STATUS_INVALID_PARAM;
+    }
+    else
+    {
+        p_profile->sharpener[0xD] =
+            (sharpener_percent*(uint8_t)255)/(uint8_t)100;
+    }
+
+    return status;
+
+} // vl53l5cx_profile_set_sharpener_percent
+
+uint8_t vl53l5cx_profile_set_target_order(
+        VL53L5CX_Profile		*p_profile,
+        uint8_t				target_order)
+{
+    uint8_t status = VL53L5CX_STATUS_OK;
+
+    if((target_order == (uint8_t)VL53L5CX_TARGET_ORDER_CLOSEST)
+            || (target_order == (uint8_t)VL53L5CX_TARGET_ORDER_STRONGEST))
+    {
+        p_profile->target_order[0x00] = target_order;
+    }
+    else
+    {
+        status |= VL53L5CX_STATUS_INVALID_PARAM;
+    }
+
+    return status;
+
+} // vl53l5cx_profile_set_target_order
+
+uint8_t vl53l5cx_profile_set_ranging_mode(
+        VL53L5CX_Profile		*p_profile,
+        uint8_t				ranging_mode)
+{
+    uint8_t status = VL53L5CX_STATUS_OK;
+    uint32_t single_range = 0x00;
+
+    /* Same fields as vl53l5cx_set_ranging_mode() */
+    switch(ranging_mode)
+    {
+        case VL53L5CX_RANGING_MODE_CONTINUOUS:
+            p_profile->ranging_mode[0x01] = 0x1;
+            p_profile->ranging_mode[0x03] = 0x3;
+            single_range = 0x00;
+            break;
+
+        case VL53L5CX_RANGING_MODE_AUTONOMOUS:
+            p_profile->ranging_mode[0x01] = 0x3;
+            p_profile->ranging_mode[0x03] = 0x2;
+            single_range = 0x01;
+            break;
+
+        default:
+            status = VL53L5CX_STATUS_INVALID_PARAM;
+            break;
+    }
+
+    if(status == VL53L5CX_STATUS_OK)
+    {
+        (void)memcpy(p_profile->single_range, &single_range, 4);
+    }
+
+    return status;
+
+} // vl53l5cx_profile_set_ranging_mode
+
+/**
+ * @brief Inner function, not available outside this file. This function writes
+ * a DCI block of a profile only if it differs from the current one.
+ */
+
+static uint8_t _vl53l5cx_apply_profile_block(
+        VL53L5CX_Configuration		*p_dev,
+        uint8_t				*current,
+        uint8_t				*wanted,
+        uint32_t			index,
+        uint16_t			size)
+{
+    uint8_t status = VL53L5CX_STATUS_OK;
+
+    if(memcmp(current, wanted, size) != 0)
+    {
+        status |= vl53l5cx_dci_write_data(p_dev, wanted, index, size);
+    }
+
+    return status;
+}
+
+uint8_t vl53l5cx_apply_profile(
+        VL53L5CX_Configuration		*p_dev,
+        VL53L5CX_Profile		*p_current,
+        VL53L5CX_Profile		*p_new)
+{
+    uint8_t status = VL53L5CX_STATUS_OK;
+
+    status |= _vl53l5cx_apply_profile_block(p_dev, p_current->dss_config,
+            p_new->dss_config, VL53L5CX_DCI_DSS_CONFIG,
+            sizeof(p_new->dss_config));
+    status |= _vl53l5cx_apply_profile_block(p_dev, p_current->zone_config,
+            p_new->zone_config, VL53L5CX_DCI_ZONE_CONFIG,
+            sizeof(p_new->zone_config));
+
+    /* Offset and Xtalk only depend on the resolution */
+    if(p_new->resolution != p_current->resolution)
+    {
+        status |= _vl53l5cx_send_offset_data(p_dev, p_new->resolution);
+        status |= _vl53l5cx_send_xtalk_data(p_dev, p_new->resolution);
+    }
+
+    status |= _vl53l5cx_apply_profile_block(p_dev, p_current->freq_hz,
+            p_new->freq_hz, VL53L5CX_DCI_FREQ_HZ,
+            sizeof(p_new->freq_hz));
+    status |= _vl53l5cx_apply_profile_block(p_dev, p_current->int_time,
+            p_new->int_time, VL53L5CX_DCI_INT_TIME,
+            sizeof(p_new->int_time));
+    status |= _vl53l5cx_apply_profile_block(p_dev, p_current->ranging_mode,
+            p_new->ranging_mode, VL53L5CX_DCI_RANGING_MODE,
+            sizeof(p_new->ranging_mode));
+    status |= _vl53l5cx_apply_profile_block(p_dev, p_current->single_range,
+            p_new->single_range, VL53L5CX_DCI_SINGLE_RANGE,
+            sizeof(p_new->single_range));
+    status |= _vl53l5cx_apply_profile_block(p_dev, p_current->target_order,
+            p_new->target_order, VL53L5CX_DCI_TARGET_ORDER,
+            sizeof(p_new->target_order));
+    status |= _vl53l5cx_apply_profile_block(p_dev, p_current->sharpener,
+            p_new->sharpener, VL53L5CX_DCI_SHARPENER,
+            sizeof(p_new->sharpener));
+
+    /* On failure, the device keeps the state of the current profile, so that
+     * the next apply resends what differs */
+    if(status == VL53L5CX_STATUS_OK)
+    {
+        (void)memcpy(p_current, p_new, sizeof(VL53L5CX_Profile));
+        p_dev->resolution = p_new->resolution;
+#ifdef VL53L5CX_LTF_FILTER
+        p_dev->target_order = p_new->target_order[0x00];
+#endif
+    }
+
+    return status;
+
+} // vl53l5cx_apply_profile
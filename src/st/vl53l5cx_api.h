@@ -2,7 +2,17 @@
 
 #include "vl53l5cx_i2.h"
 
-static const uint8_t VL53L5CX_NB_TARGET_PER_ZONE = 1; 
+/**
+ * @brief Macro VL53L5CX_NB_TARGET_PER_ZONE is the maximum number of targets per
+ * zone (1 to 4), which sizes the results structures. The number of targets
+ * really streamed is selected per device using
+ * vl53l5cx_set_nb_target_per_zone(). Must be a macro, as it is used by the
+ * preprocessor.
+ */
+
+#ifndef VL53L5CX_NB_TARGET_PER_ZONE
+#define VL53L5CX_NB_TARGET_PER_ZONE		1U
+#endif
 
 
 /**
@@ -71,33 +81,10 @@ static const uint8_t VL53L5CX_NB_TARGET_PER_ZONE = 1;
  * @brief Definitions for Range results block headers
  */
 
-#if VL53L5CX_NB_TARGET_PER_ZONE == 1
-
-#define VL53L5CX_START_BH			((uint32_t)0x0000000DU)
-#define VL53L5CX_METADATA_BH			((uint32_t)0x54B400C0U)
-#define VL53L5CX_COMMONDATA_BH			((uint32_t)0x54C00040U)
-#define VL53L5CX_AMBIENT_RATE_BH		((uint32_t)0x54D00104U)
-#define VL53L5CX_SPAD_COUNT_BH			((uint32_t)0x55D00404U)
-#define VL53L5CX_NB_TARGET_DETECTED_BH	        ((uint32_t)0xCF7C0401U)
-#define VL53L5CX_SIGNAL_RATE_BH			((uint32_t)0xCFBC0404U)
-#define VL53L5CX_RANGE_SIGMA_MM_BH		((uint32_t)0xD2BC0402U)
-#define VL53L5CX_DISTANCE_BH			((uint32_t)0xD33C0402U)
-#define VL53L5CX_REFLECTANCE_BH			((uint32_t)0xD43C0401U)
-#define VL53L5CX_TARGET_STATUS_BH		((uint32_t)0xD47C0401U)
-#define VL53L5CX_MOTION_DETECT_BH		((uint32_t)0xCC5008C0U)
-
-#define VL53L5CX_METADATA_IDX			((uint16_t)0x54B4U)
-#define VL53L5CX_SPAD_COUNT_IDX			((uint16_t)0x55D0U)
-#define VL53L5CX_AMBIENT_RATE_IDX		((uint16_t)0x54D0U)
-#define VL53L5CX_NB_TARGET_DETECTED_IDX		((uint16_t)0xCF7CU)
-#define VL53L5CX_SIGNAL_RATE_IDX		((uint16_t)0xCFBCU)
-#define VL53L5CX_RANGE_SIGMA_MM_IDX		((uint16_t)0xD2BCU)
-#define VL53L5CX_DISTANCE_IDX			((uint16_t)0xD33CU)
-#define VL53L5CX_REFLECTANCE_EST_PC_IDX		((uint16_t)0xD43CU)
-#define VL53L5CX_TARGET_STATUS_IDX		((uint16_t)0xD47CU)
-#define VL53L5CX_MOTION_DETEC_IDX		((uint16_t)0xCC50U)
-
-#else
+/* The multi-target layout is always used, with the number of targets per zone
+ * set at runtime (VL53L5CX_DCI_FW_NB_TARGET), so that it can change without
+ * rebuilding. With one target it streams as many bytes as the single-target
+ * layout. */
 #define VL53L5CX_START_BH			((uint32_t)0x0000000DU)
 #define VL53L5CX_METADATA_BH			((uint32_t)0x54B400C0U)
 #define VL53L5CX_COMMONDATA_BH			((uint32_t)0x54C00040U)
@@ -121,13 +108,30 @@ static const uint8_t VL53L5CX_NB_TARGET_PER_ZONE = 1;
 #define VL53L5CX_REFLECTANCE_EST_PC_IDX		((uint16_t)0x6A90U)
 #define VL53L5CX_TARGET_STATUS_IDX		((uint16_t)0x6B90U)
 #define VL53L5CX_MOTION_DETEC_IDX		((uint16_t)0xCC50U)
-#endif
+
+/**
+ * @brief Output blocks which can be selected at runtime for each device, using
+ * vl53l5cx_set_outputs(). Bits match the firmware output enables. Blocks
+ * disabled at compile time by VL53L5CX_DISABLE_* macros are never streamed.
+ */
+
+#define VL53L5CX_OUTPUT_AMBIENT_PER_SPAD	((uint32_t)0x008U)
+#define VL53L5CX_OUTPUT_NB_SPADS_ENABLED	((uint32_t)0x010U)
+#define VL53L5CX_OUTPUT_NB_TARGET_DETECTED	((uint32_t)0x020U)
+#define VL53L5CX_OUTPUT_SIGNAL_PER_SPAD		((uint32_t)0x040U)
+#define VL53L5CX_OUTPUT_RANGE_SIGMA_MM		((uint32_t)0x080U)
+#define VL53L5CX_OUTPUT_DISTANCE_MM		((uint32_t)0x100U)
+#define VL53L5CX_OUTPUT_REFLECTANCE_PERCENT	((uint32_t)0x200U)
+#define VL53L5CX_OUTPUT_TARGET_STATUS		((uint32_t)0x400U)
+#define VL53L5CX_OUTPUT_MOTION_INDICATOR	((uint32_t)0x800U)
+#define VL53L5CX_OUTPUT_ALL			((uint32_t)0xFF8U)
 
 
 /**
  * @brief Inner Macro for API. Not for user, only for development.
  */
 
+#define VL53L5CX_FIRMWARE_SIZE			((uint32_t)86016U)
 #define VL53L5CX_NVM_DATA_SIZE			((uint16_t)492U)
 #define VL53L5CX_CONFIGURATION_SIZE		((uint16_t)972U)
 #define VL53L5CX_OFFSET_BUFFER_SIZE		((uint16_t)488U)
@@ -152,54 +156,74 @@ static const uint8_t VL53L5CX_NB_TARGET_PER_ZONE = 1;
 #define VL53L5CX_UI_CMD_START			((uint16_t)0x2C04U)
 #define VL53L5CX_UI_CMD_END			((uint16_t)0x2FFFU)
 
+/**
+ * @brief Macro VL53L5CX_MAX_RESOLUTION indicates the largest number of zones
+ * that will be streamed. Defining it to 16U (VL53L5CX_RESOLUTION_4X4) before
+ * including this file sizes the temporary buffer for 4x4 frames only; starting
+ * 8x8 ranging then fails with VL53L5CX_STATUS_INVALID_PARAM.
+ */
+
+#ifndef VL53L5CX_MAX_RESOLUTION
+#define VL53L5CX_MAX_RESOLUTION		64U
+#endif
+
+#if (VL53L5CX_MAX_RESOLUTION != 16U) && (VL53L5CX_MAX_RESOLUTION != 64U)
+#error "VL53L5CX_MAX_RESOLUTION must be 16U or 64U"
+#endif
+
 /**
  * @brief Inner values for API. Max buffer size depends of the selected output.
  */
 
 #ifndef VL53L5CX_DISABLE_AMBIENT_PER_SPAD
-#define L5CX_AMB_SIZE	260U
+#define L5CX_AMB_SIZE	((4U * VL53L5CX_MAX_RESOLUTION) + 4U)
 #else
 #define L5CX_AMB_SIZE	0U
 #endif
 
 #ifndef VL53L5CX_DISABLE_NB_SPADS_ENABLED
-#define L5CX_SPAD_SIZE	260U
+#define L5CX_SPAD_SIZE	((4U * VL53L5CX_MAX_RESOLUTION) + 4U)
 #else
 #define L5CX_SPAD_SIZE	0U
 #endif
 
 #ifndef VL53L5CX_DISABLE_NB_TARGET_DETECTED
-#define L5CX_NTAR_SIZE	68U
+#define L5CX_NTAR_SIZE	(VL53L5CX_MAX_RESOLUTION + 4U)
 #else
 #define L5CX_NTAR_SIZE	0U
 #endif
 
 #ifndef VL53L5CX_DISABLE_SIGNAL_PER_SPAD
-#define L5CX_SPS_SIZE ((256U * VL53L5CX_NB_TARGET_PER_ZONE) + 4U)
+#define L5CX_SPS_SIZE \
+	((4U * VL53L5CX_MAX_RESOLUTION * VL53L5CX_NB_TARGET_PER_ZONE) + 4U)
 #else
 #define L5CX_SPS_SIZE	0U
 #endif
 
 #ifndef VL53L5CX_DISABLE_RANGE_SIGMA_MM
-#define L5CX_SIGR_SIZE ((128U * VL53L5CX_NB_TARGET_PER_ZONE) + 4U)
+#define L5CX_SIGR_SIZE \
+	((2U * VL53L5CX_MAX_RESOLUTION * VL53L5CX_NB_TARGET_PER_ZONE) + 4U)
 #else
 #define L5CX_SIGR_SIZE	0U
 #endif
 
 #ifndef VL53L5CX_DISABLE_DISTANCE_MM
-#define L5CX_DIST_SIZE ((128U * VL53L5CX_NB_TARGET_PER_ZONE) + 4U)
+#define L5CX_DIST_SIZE \
+	((2U * VL53L5CX_MAX_RESOLUTION * VL53L5CX_NB_TARGET_PER_ZONE) + 4U)
 #else
 #define L5CX_DIST_SIZE	0U
 #endif
 
 #ifndef VL53L5CX_DISABLE_REFLECTANCE_PERCENT
-#define L5CX_RFLEST_SIZE ((64U *VL53L5CX_NB_TARGET_PER_ZONE) + 4U)
+#define L5CX_RFLEST_SIZE \
+	((VL53L5CX_MAX_RESOLUTION * VL53L5CX_NB_TARGET_PER_ZONE) + 4U)
 #else
 #define L5CX_RFLEST_SIZE	0U
 #endif
 
 #ifndef VL53L5CX_DISABLE_TARGET_STATUS
-#define L5CX_STA_SIZE ((64U  *VL53L5CX_NB_TARGET_PER_ZONE) + 4U)
+#define L5CX_STA_SIZE \
+	((VL53L5CX_MAX_RESOLUTION * VL53L5CX_NB_TARGET_PER_ZONE) + 4U)
 #else
 #define L5CX_STA_SIZE	0U
 #endif
@@ -221,15 +245,25 @@ static const uint8_t VL53L5CX_NB_TARGET_PER_ZONE = 1;
 	+ L5CX_SIGR_SIZE + L5CX_DIST_SIZE + L5CX_RFLEST_SIZE + L5CX_STA_SIZE \
 	+ L5CX_MOT_SIZE + 8U)
 
+/**
+ * @brief Macro VL53L5CX_MAX_COMMAND_SIZE indicates the largest transfer other
+ * than a ranging frame. The crosstalk calibration data read with its 4-byte
+ * header (776 + 4) and the 64 detection thresholds written with the 12-byte DCI
+ * header and footer (768 + 12) are equal; the NVM (492), offset (488), motion
+ * configuration (156 + 12) and other DCI transfers are smaller. Each of these
+ * is checked against VL53L5CX_TEMPORARY_BUFFER_SIZE where it is sent.
+ */
+
+#define VL53L5CX_MAX_COMMAND_SIZE	780U
+
 /**
  * @brief Macro VL53L5CX_TEMPORARY_BUFFER_SIZE can be used to know the size of
- * the temporary buffer. The minimum size is 1024, and the maximum depends of
- * the output configuration.
+ * the temporary buffer: the largest of the command transfers and of the frame
+ * for the outputs, resolution and targets allowed by the macros above.
  */
 
-#if VL53L5CX_MAX_RESULTS_SIZE < 1024U
-//#define VL53L5CX_TEMPORARY_BUFFER_SIZE ((uint32_t) 1024U)
-#define VL53L5CX_TEMPORARY_BUFFER_SIZE ((uint32_t) 4096U)
+#if VL53L5CX_MAX_RESULTS_SIZE < VL53L5CX_MAX_COMMAND_SIZE
+#define VL53L5CX_TEMPORARY_BUFFER_SIZE ((uint32_t) VL53L5CX_MAX_COMMAND_SIZE)
 #else
 #define VL53L5CX_TEMPORARY_BUFFER_SIZE ((uint32_t) VL53L5CX_MAX_RESULTS_SIZE)
 #endif
@@ -251,6 +285,74 @@ static const uint8_t VL53L5CX_NB_TARGET_PER_ZONE = 1;
 #endif
 
 
+/**
+ * @brief Macro VL53L5CX_MAX_DECODE_STEPS indicates the maximum number of steps
+ * of the decode plan, one per optional output block.
+ */
+
+#define VL53L5CX_MAX_DECODE_STEPS		((uint8_t)9U)
+
+/**
+ * @brief Conversions applied by the decoder to an output block, from firmware
+ * format to real format.
+ */
+
+#define VL53L5CX_CONVERSION_NONE		((uint8_t)0U)
+#define VL53L5CX_CONVERSION_KCPS		((uint8_t)1U)
+#define VL53L5CX_CONVERSION_SIGMA		((uint8_t)2U)
+#define VL53L5CX_CONVERSION_DISTANCE		((uint8_t)3U)
+#define VL53L5CX_CONVERSION_MOTION		((uint8_t)4U)
+#define VL53L5CX_CONVERSION_STATUS		((uint8_t)5U)
+
+/**
+ * @brief Structure VL53L5CX_DecodeStep describes how to decode one output block
+ * of a frame. The decode plan is computed by vl53l5cx_start_ranging(), from the
+ * output list sent to the sensor.
+ */
+
+typedef struct
+{
+	/* Block index, checked against the block header on each frame */
+	uint16_t	idx;
+	/* Position of the block data into the temporary buffer */
+	uint16_t	src_offset;
+	/* Position of the field into VL53L5CX_ResultsData */
+	uint16_t	dst_offset;
+	/* Size of the block data in bytes */
+	uint16_t	size;
+	/* Conversion to real format (VL53L5CX_CONVERSION_...) */
+	uint8_t		conversion;
+} VL53L5CX_DecodeStep;
+
+/**
+ * @brief Structure VL53L5CX_Scratch contains the temporary buffer used for DCI
+ * operations and frame reads. As these operations are serialized on a bus, a
+ * single scratch can be shared by all the devices of the bus, which must then
+ * not be used concurrently. See vl53l5cx_set_scratch().
+ */
+
+typedef struct
+{
+	/* Device whose last frame is still in the buffer, NULL if none */
+	const void		*p_frame_owner;
+	/* Temporary buffer used for internal driver processing */
+	uint8_t			buffer[VL53L5CX_TEMPORARY_BUFFER_SIZE];
+} VL53L5CX_Scratch;
+
+/**
+ * @brief Structure VL53L5CX_Calibration contains the offsets of one sensor,
+ * only used by vl53l5cx_init() and vl53l5cx_set_resolution(). It is kept out of
+ * VL53L5CX_Configuration, so that the state used on each frame stays small.
+ * See vl53l5cx_set_calibration(). Sensors calibrating xtalk also need their own
+ * xtalk storage, see vl53l5cx_set_xtalk_storage().
+ */
+
+typedef struct
+{
+	/* Offset buffer, read from the NVM by vl53l5cx_init() */
+	uint8_t			offset_data[VL53L5CX_OFFSET_BUFFER_SIZE];
+} VL53L5CX_Calibration;
+
 /**
  * @brief Structure VL53L5CX_Configuration contains the sensor configuration.
  * User MUST not manually change these field, except for the sensor address.
@@ -268,16 +370,30 @@ typedef struct
 	uint8_t		        *default_configuration;
 	/* Address of default Xtalk buffer */
 	uint8_t		        *default_xtalk;
-	/* Offset buffer */
-	uint8_t		        offset_data[VL53L5CX_OFFSET_BUFFER_SIZE];
-	/* Xtalk buffer */
-	uint8_t		        xtalk_data[VL53L5CX_XTALK_BUFFER_SIZE];
-	/* Temporary buffer used for internal driver processing */
-	uint8_t		temp_buffer[VL53L5CX_TEMPORARY_BUFFER_SIZE];
+	/* Calibration of the sensor */
+	VL53L5CX_Calibration	*p_calibration;
+	/* Xtalk sent to the sensor: default_xtalk, read in place and shared by
+	 * all the devices, until the xtalk plugin sets the xtalk storage */
+	const uint8_t		*p_xtalk_data;
+	/* Xtalk buffer written by the xtalk plugin, NULL if none was selected */
+	uint8_t			*p_xtalk_storage;
+	/* Scratch borrowed for internal driver processing */
+	VL53L5CX_Scratch	*p_scratch;
+	/* Buffer of the scratch */
+	uint8_t			*temp_buffer;
+	/* Decode plan of the current ranging session */
+	VL53L5CX_DecodeStep	decode_plan[VL53L5CX_MAX_DECODE_STEPS];
+	/* Number of steps in the plan, 0 to decode by walking block headers */
+	uint8_t			decode_plan_size;
+	/* Active resolution (16 or 64 zones), only these zones are decoded */
+	uint8_t			resolution;
+	/* Targets per zone (1 to VL53L5CX_NB_TARGET_PER_ZONE) */
+	uint8_t			nb_target_per_zone;
+	/* Output blocks streamed from next start (VL53L5CX_OUTPUT_...) */
+	uint32_t		outputs;
 	/* Internal Data for long tail filter */
 #ifdef VL53L5CX_LTF_FILTER
 	uint8_t			target_order;
-	uint8_t			resolution;
 #endif
 
 } VL53L5CX_Configuration;
@@ -296,6 +412,11 @@ typedef struct
 
 typedef struct
 {
+	/* Number of zones carrying data (16 or 64), next entries are stale */
+	uint8_t nb_zones;
+	/* Targets per zone, stride of the per target arrays */
+	uint8_t nb_target_per_zone;
+
 	/* Ambiant noise in kcps/spads */
 #ifndef VL53L5CX_DISABLE_AMBIENT_PER_SPAD
 	uint32_t ambient_per_spad[VL53L5CX_RESOLUTION_8X8];
@@ -358,6 +479,158 @@ typedef struct
 } VL53L5CX_ResultsData;
 
 
+/**
+ * @brief Structure VL53L5CX_ResultsFloat contains the main ranging results as
+ * contiguous float arrays in SI-like units, written directly by
+ * vl53l5cx_get_ranging_data_float(). Arrays use the same indexing as
+ * VL53L5CX_ResultsData.
+ */
+
+typedef struct
+{
+	/* Number of zones carrying data (16 or 64), next entries are stale */
+	uint8_t nb_zones;
+	/* Targets per zone, stride of the per target arrays */
+	uint8_t nb_target_per_zone;
+
+#ifndef VL53L5CX_DISABLE_NB_TARGET_DETECTED
+	uint8_t nb_target_detected[VL53L5CX_RESOLUTION_8X8];
+#endif
+#ifndef VL53L5CX_DISABLE_TARGET_STATUS
+	uint8_t target_status[(VL53L5CX_RESOLUTION_8X8
+					*VL53L5CX_NB_TARGET_PER_ZONE)];
+#endif
+	/* Ambient noise in kcps/spads */
+#ifndef VL53L5CX_DISABLE_AMBIENT_PER_SPAD
+	float ambient_kcps[VL53L5CX_RESOLUTION_8X8];
+#endif
+	/* Signal in kcps/spads */
+#ifndef VL53L5CX_DISABLE_SIGNAL_PER_SPAD
+	float signal_kcps[(VL53L5CX_RESOLUTION_8X8
+					*VL53L5CX_NB_TARGET_PER_ZONE)];
+#endif
+	/* Sigma of the distance in m */
+#ifndef VL53L5CX_DISABLE_RANGE_SIGMA_MM
+	float range_sigma_m[(VL53L5CX_RESOLUTION_8X8
+					*VL53L5CX_NB_TARGET_PER_ZONE)];
+#endif
+	/* Distance in m, negative distances are clamped to 0 */
+#ifndef VL53L5CX_DISABLE_DISTANCE_MM
+	float distance_m[(VL53L5CX_RESOLUTION_8X8
+					*VL53L5CX_NB_TARGET_PER_ZONE)];
+#endif
+
+} VL53L5CX_ResultsFloat;
+
+
+/**
+ * @brief Structure VL53L5CX_ResultsFixed contains the same results as
+ * VL53L5CX_ResultsFloat in Q16.16 fixed point (value * 65536), for targets
+ * without a FPU. Rates above 32767 kcps/spads saturate.
+ */
+
+typedef struct
+{
+	/* Number of zones carrying data (16 or 64), next entries are stale */
+	uint8_t nb_zones;
+	/* Targets per zone, stride of the per target arrays */
+	uint8_t nb_target_per_zone;
+
+#ifndef VL53L5CX_DISABLE_NB_TARGET_DETECTED
+	uint8_t nb_target_detected[VL53L5CX_RESOLUTION_8X8];
+#endif
+#ifndef VL53L5CX_DISABLE_TARGET_STATUS
+	uint8_t target_status[(VL53L5CX_RESOLUTION_8X8
+					*VL53L5CX_NB_TARGET_PER_ZONE)];
+#endif
+#ifndef VL53L5CX_DISABLE_AMBIENT_PER_SPAD
+	int32_t ambient_kcps_q16[VL53L5CX_RESOLUTION_8X8];
+#endif
+#ifndef VL53L5CX_DISABLE_SIGNAL_PER_SPAD
+	int32_t signal_kcps_q16[(VL53L5CX_RESOLUTION_8X8
+					*VL53L5CX_NB_TARGET_PER_ZONE)];
+#endif
+#ifndef VL53L5CX_DISABLE_RANGE_SIGMA_MM
+	int32_t range_sigma_m_q16[(VL53L5CX_RESOLUTION_8X8
+					*VL53L5CX_NB_TARGET_PER_ZONE)];
+#endif
+#ifndef VL53L5CX_DISABLE_DISTANCE_MM
+	int32_t distance_m_q16[(VL53L5CX_RESOLUTION_8X8
+					*VL53L5CX_NB_TARGET_PER_ZONE)];
+#endif
+
+} VL53L5CX_ResultsFixed;
+
+
+/**
+ * @brief Structure VL53L5CX_Results4x4 contains the ranging results of a 4x4
+ * session, written directly by vl53l5cx_get_ranging_data_4x4(). Values are in
+ * the units of VL53L5CX_ResultsData, using the narrowest type they fit in:
+ * rates in kcps/spads saturate at 65535. Motion results are not included.
+ */
+
+typedef struct
+{
+	/* Targets per zone, stride of the per target arrays */
+	uint8_t nb_target_per_zone;
+
+#ifndef VL53L5CX_DISABLE_NB_TARGET_DETECTED
+	uint8_t nb_target_detected[VL53L5CX_RESOLUTION_4X4];
+#endif
+#ifndef VL53L5CX_DISABLE_NB_SPADS_ENABLED
+	uint32_t nb_spads_enabled[VL53L5CX_RESOLUTION_4X4];
+#endif
+#ifndef VL53L5CX_DISABLE_AMBIENT_PER_SPAD
+	uint16_t ambient_per_spad[VL53L5CX_RESOLUTION_4X4];
+#endif
+#ifndef VL53L5CX_DISABLE_SIGNAL_PER_SPAD
+	uint16_t signal_per_spad[(VL53L5CX_RESOLUTION_4X4
+					*VL53L5CX_NB_TARGET_PER_ZONE)];
+#endif
+#ifndef VL53L5CX_DISABLE_RANGE_SIGMA_MM
+	uint16_t range_sigma_mm[(VL53L5CX_RESOLUTION_4X4
+					*VL53L5CX_NB_TARGET_PER_ZONE)];
+#endif
+#ifndef VL53L5CX_DISABLE_DISTANCE_MM
+	int16_t distance_mm[(VL53L5CX_RESOLUTION_4X4
+					*VL53L5CX_NB_TARGET_PER_ZONE)];
+#endif
+#ifndef VL53L5CX_DISABLE_REFLECTANCE_PERCENT
+	uint8_t reflectance[(VL53L5CX_RESOLUTION_4X4
+					*VL53L5CX_NB_TARGET_PER_ZONE)];
+#endif
+#ifndef VL53L5CX_DISABLE_TARGET_STATUS
+	uint8_t target_status[(VL53L5CX_RESOLUTION_4X4
+					*VL53L5CX_NB_TARGET_PER_ZONE)];
+#endif
+
+} VL53L5CX_Results4x4;
+
+
+/**
+ * @brief Structure VL53L5CX_Profile contains a precomputed image of every DCI
+ * block written by the sensing settings (resolution, frequency, integration
+ * time, ranging mode, target order and sharpener). Blocks are stored in host
+ * byte order, as returned by vl53l5cx_dci_read_data(). A profile is captured
+ * once from the sensor using vl53l5cx_get_profile(), modified offline using the
+ * vl53l5cx_profile_set_*() functions, and sent using vl53l5cx_apply_profile().
+ */
+
+typedef struct
+{
+	/* Resolution (16 or 64), used to know if calibration must be resent */
+	uint8_t		resolution;
+	uint8_t		zone_config[8];
+	uint8_t		dss_config[16];
+	uint8_t		freq_hz[4];
+	uint8_t		int_time[20];
+	uint8_t		ranging_mode[8];
+	uint8_t		single_range[4];
+	uint8_t		target_order[4];
+	uint8_t		sharpener[16];
+} VL53L5CX_Profile;
+
+
 union Block_header {
 	uint32_t bytes;
 	struct {
@@ -371,12 +644,63 @@ uint8_t vl53l5cx_is_alive(
 		VL53L5CX_Configuration		*p_dev,
 		uint8_t				*p_is_alive);
 
+/**
+ * @brief Mandatory function preparing a configuration structure, before its
+ * platform fields are filled and before any other function of the driver. It
+ * zeroes the structure and selects the scratch of the driver, so that a
+ * configuration allocated on the stack is safe to use.
+ * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
+ * @return (uint8_t) status : Always 0.
+ */
+
+uint8_t vl53l5cx_config_init(
+		VL53L5CX_Configuration		*p_dev);
+
+/**
+ * @brief Function selecting the scratch buffer of the device, after
+ * vl53l5cx_config_init() and before vl53l5cx_init(). Without it, the device
+ * uses the scratch of the driver. Devices sharing a scratch only keep their last frame in it until
+ * another one uses it, which matters for vl53l5cx_get_raw_data().
+ * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
+ * @param (VL53L5CX_Scratch) *p_scratch : Scratch buffer, or NULL for the one
+ * of the driver, shared by all the devices which select it.
+ * @return (uint8_t) status : Always 0.
+ */
+
+uint8_t vl53l5cx_set_scratch(
+		VL53L5CX_Configuration		*p_dev,
+		VL53L5CX_Scratch		*p_scratch);
+
+/**
+ * @brief Mandatory function selecting the calibration storage of the device. It
+ * must be called before vl53l5cx_init(), which fails without it: unlike ST's
+ * driver, the offsets are not kept in VL53L5CX_Configuration, so existing
+ * callers must add this call. The calibration is only accessed when the sensor
+ * is initialized or when the resolution changes. It also clears the xtalk
+ * storage, which vl53l5cx_set_xtalk_storage() selects afterwards.
+ * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
+ * @param (VL53L5CX_Calibration) *p_calibration : Calibration of this device,
+ * which must outlive it. It cannot be shared, as offsets differ between
+ * sensors.
+ * @return (uint8_t) status : 0 if OK, or 127 if p_calibration is NULL.
+ */
+
+uint8_t vl53l5cx_set_calibration(
+		VL53L5CX_Configuration		*p_dev,
+		VL53L5CX_Calibration		*p_calibration);
+
 /**
  * @brief Mandatory function used to initialize the sensor. This function must
  * be called after a power on, to load the firmware into the VL53L5CX. It takes
- * a few hundred milliseconds.
+ * a few hundred milliseconds. The configuration structure must be prepared
+ * beforehand by vl53l5cx_config_init(), and its calibration storage selected
+ * by vl53l5cx_set_calibration(). If no scratch buffer was selected by
+ * vl53l5cx_set_scratch(), the scratch of the driver, shared with every other
+ * device which does not select one, is used.
  * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
- * @return (uint8_t) status : 0 if initialization is OK.
+ * @return (uint8_t) status : 0 if initialization is OK, or 127 if no
+ * calibration storage was selected (breaking change from ST's driver, see
+ * vl53l5cx_set_calibration()).
  */
 
 uint8_t vl53l5cx_init(
@@ -446,6 +770,20 @@ uint8_t vl53l5cx_start_ranging(
 uint8_t vl53l5cx_stop_ranging(
 		VL53L5CX_Configuration		*p_dev);
 
+/**
+ * @brief This function restarts a ranging session that was stopped with
+ * vl53l5cx_stop_ranging(), without re-programming the output list. It is much
+ * faster than vl53l5cx_start_ranging(), but it can only be used if the
+ * resolution has not changed since the last call to vl53l5cx_start_ranging().
+ * Settings such as frequency, integration time, sharpener or target order can
+ * be changed between the stop and the resume.
+ * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
+ * @return (uint8_t) status : 0 if resume is OK.
+ */
+
+uint8_t vl53l5cx_resume_ranging(
+		VL53L5CX_Configuration		*p_dev);
+
 /**
  * @brief This function checks if a new data is ready by polling I2C. If a new
  * data is ready, a flag will be raised.
@@ -471,6 +809,141 @@ uint8_t vl53l5cx_get_ranging_data(
 		VL53L5CX_Configuration		*p_dev,
 		VL53L5CX_ResultsData		*p_results);
 
+/**
+ * @brief This function only reads the raw ranging data into the temporary
+ * buffer, without decoding them. Fields are then decoded on demand using
+ * vl53l5cx_decode_field(), so unused fields cost nothing. Until all the needed
+ * fields are decoded, no other function using the scratch buffer can be
+ * called, for this device or any other sharing its scratch (except
+ * vl53l5cx_check_data_ready()). The long tail filter is not applied.
+ * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
+ * @param (VL53L5CX_ResultsData) *p_results : VL53L5 results structure, only
+ * the number of zones is updated. Can be NULL when the frame is used through a
+ * VL53L5CX_FrameView.
+ * @return (uint8_t) status : 0 data are successfully read.
+ */
+
+uint8_t vl53l5cx_get_raw_data(
+		VL53L5CX_Configuration		*p_dev,
+		VL53L5CX_ResultsData		*p_results);
+
+/**
+ * @brief This function gets the ranging data as float arrays, converted in a
+ * single pass from the raw frame. Other blocks are not decoded, and the long
+ * tail filter is not applied.
+ * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
+ * @param (VL53L5CX_ResultsFloat) *p_results : Float results structure.
+ * @return (uint8_t) status : 0 data are successfully get, or 255 if the frame
+ * does not match the current session.
+ */
+
+uint8_t vl53l5cx_get_ranging_data_float(
+		VL53L5CX_Configuration		*p_dev,
+		VL53L5CX_ResultsFloat		*p_results);
+
+/**
+ * @brief This function gets the ranging data as Q16.16 fixed point arrays,
+ * converted in a single pass from the raw frame. Other blocks are not decoded,
+ * and the long tail filter is not applied.
+ * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
+ * @param (VL53L5CX_ResultsFixed) *p_results : Fixed point results structure.
+ * @return (uint8_t) status : 0 data are successfully get, or 255 if the frame
+ * does not match the current session.
+ */
+
+uint8_t vl53l5cx_get_ranging_data_fixed(
+		VL53L5CX_Configuration		*p_dev,
+		VL53L5CX_ResultsFixed		*p_results);
+
+/**
+ * @brief This function gets the ranging data of a 4x4 session into the
+ * compact VL53L5CX_Results4x4, converted in a single pass from the raw frame.
+ * Motion results are not decoded, and the long tail filter is not applied.
+ * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
+ * @param (VL53L5CX_Results4x4) *p_results : Compact results structure.
+ * @return (uint8_t) status : 0 data are successfully get, 127 if the session
+ * is not 4x4 (nothing is read), or 255 if the frame does not match the current
+ * session.
+ */
+
+uint8_t vl53l5cx_get_ranging_data_4x4(
+		VL53L5CX_Configuration		*p_dev,
+		VL53L5CX_Results4x4		*p_results);
+
+/**
+ * @brief This function decodes one field of the raw data read by
+ * vl53l5cx_get_raw_data(). Decoding the target status also decodes the number
+ * of targets, if it is selected.
+ * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
+ * @param (VL53L5CX_ResultsData) *p_results : VL53L5 results structure.
+ * @param (uint32_t) output : One VL53L5CX_OUTPUT_... flag.
+ * @return (uint8_t) status : 0 if the field is decoded, or 255 if the field is
+ * not selected, if the scratch buffer was used since the raw data were read, or
+ * if they do not match the current session.
+ */
+
+uint8_t vl53l5cx_decode_field(
+		VL53L5CX_Configuration		*p_dev,
+		VL53L5CX_ResultsData		*p_results,
+		uint32_t			output);
+
+/**
+ * @brief This function selects the output blocks streamed by the sensor, to
+ * reduce the I2C transfer of each frame to the data really used. It is applied
+ * by the next vl53l5cx_start_ranging(). vl53l5cx_init() selects all the blocks
+ * enabled at compile time. Fields of blocks which are not selected are not
+ * updated in VL53L5CX_ResultsData. Target status is set to 255 for zones
+ * without target only if the number of targets is selected.
+ * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
+ * @param (uint32_t) outputs : Combination of VL53L5CX_OUTPUT_... flags. Blocks
+ * disabled at compile time are ignored.
+ * @return (uint8_t) status : 0 if outputs are OK, or 127 if an unknown flag is
+ * used.
+ */
+
+uint8_t vl53l5cx_set_outputs(
+		VL53L5CX_Configuration		*p_dev,
+		uint32_t			outputs);
+
+/**
+ * @brief This function gets the output blocks selected for the next ranging
+ * session.
+ * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
+ * @param (uint32_t) *p_outputs : Combination of VL53L5CX_OUTPUT_... flags.
+ * @return (uint8_t) status : Always 0.
+ */
+
+uint8_t vl53l5cx_get_outputs(
+		VL53L5CX_Configuration		*p_dev,
+		uint32_t			*p_outputs);
+
+/**
+ * @brief This function sets the number of targets detected per zone. It must
+ * be used when the sensor is not ranging, and is applied by the next
+ * vl53l5cx_start_ranging(). Per target results are stored with a stride of
+ * nb_target_per_zone entries per zone.
+ * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
+ * @param (uint8_t) nb_target_per_zone : Between 1 and
+ * VL53L5CX_NB_TARGET_PER_ZONE.
+ * @return (uint8_t) status : 0 if programming is OK, or 127 if the number is
+ * out of range.
+ */
+
+uint8_t vl53l5cx_set_nb_target_per_zone(
+		VL53L5CX_Configuration		*p_dev,
+		uint8_t				nb_target_per_zone);
+
+/**
+ * @brief This function gets the number of targets detected per zone.
+ * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
+ * @param (uint8_t) *p_nb_target_per_zone : Number of targets per zone.
+ * @return (uint8_t) status : Always 0.
+ */
+
+uint8_t vl53l5cx_get_nb_target_per_zone(
+		VL53L5CX_Configuration		*p_dev,
+		uint8_t				*p_nb_target_per_zone);
+
 /**
  * @brief This function gets the current resolution (4x4 or 8x8).
  * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
@@ -665,6 +1138,25 @@ uint8_t vl53l5cx_dci_write_data(
 		uint32_t			index,
 		uint16_t			data_size);
 
+/**
+ * @brief This function writes 'extra data' to DCI like
+ * vl53l5cx_dci_write_data(), from data already in firmware byte order (32 bits
+ * big-endian words, e.g. converted once using vl53l5cx_swap_buffer()). The
+ * data is sent as is and never modified, so it can be kept constant.
+ * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
+ * @param (uint8_t) *data : Data in firmware byte order, with a size multiple
+ * of 32 bits.
+ * @param (uint32_t) index : Index of required value.
+ * @param (uint16_t)*data_size : Data size in bytes.
+ * @return (uint8_t) status : 0 if OK
+ */
+
+uint8_t vl53l5cx_dci_write_wire_data(
+		VL53L5CX_Configuration		*p_dev,
+		const uint8_t			*data,
+		uint32_t			index,
+		uint16_t			data_size);
+
 /**
  * @brief This function can be used to replace 'extra data' in DCI. The data can
  * be simple data, or casted structure.
@@ -689,3 +1181,78 @@ uint8_t vl53l5cx_dci_replace_data(
 		uint8_t				*new_data,
 		uint16_t			new_data_size,
 		uint16_t			new_data_pos);
+
+/**
+ * @brief This function converts a buffer between the firmware format
+ * (big-endian 32 bits words) and the host format. It is used on every frame and
+ * DCI transfer. A vectorized version is selected at compile time when the
+ * target supports it (AVX2, SSSE3 or NEON).
+ * @param (uint8_t) *buffer : Buffer to convert in place.
+ * @param (uint16_t) size : Buffer size in bytes, must be a multiple of 4.
+ */
+
+void vl53l5cx_swap_buffer(
+		uint8_t				*buffer,
+		uint16_t			size);
+
+/**
+ * @brief This function reads the DCI blocks of all sensing settings into a
+ * profile. It is generally used once after vl53l5cx_init(), to get the base
+ * images that other profiles are built from.
+ * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
+ * @param (VL53L5CX_Profile) *p_profile : Profile filled with the current
+ * sensor settings.
+ * @return (uint8_t) status : 0 if OK
+ */
+
+uint8_t vl53l5cx_get_profile(
+		VL53L5CX_Configuration		*p_dev,
+		VL53L5CX_Profile		*p_profile);
+
+/**
+ * @brief The following functions change a setting inside a profile, without
+ * any I2C access. They use the same arguments and return the same status as
+ * the equivalent vl53l5cx_set_*() functions.
+ */
+
+uint8_t vl53l5cx_profile_set_resolution(
+		VL53L5CX_Profile		*p_profile,
+		uint8_t				resolution);
+
+uint8_t vl53l5cx_profile_set_ranging_frequency_hz(
+		VL53L5CX_Profile		*p_profile,
+		uint8_t				frequency_hz);
+
+uint8_t vl53l5cx_profile_set_integration_time_ms(
+		VL53L5CX_Profile		*p_profile,
+		uint32_t			integration_time_ms);
+
+uint8_t vl53l5cx_profile_set_sharpener_percent(
+		VL53L5CX_Profile		*p_profile,
+		uint8_t				sharpener_percent);
+
+uint8_t vl53l5cx_profile_set_target_order(
+		VL53L5CX_Profile		*p_profile,
+		uint8_t				target_order);
+
+uint8_t vl53l5cx_profile_set_ranging_mode(
+		VL53L5CX_Profile		*p_profile,
+		uint8_t				ranging_mode);
+
+/**
+ * @brief This function switches the sensor from a profile to another one. Only
+ * the DCI blocks which differ between both profiles are written, and offset and
+ * Xtalk calibration are only sent if the resolution changes. The sensor must
+ * not be streaming. If the resolution changed, vl53l5cx_start_ranging() must be
+ * used to restart, otherwise vl53l5cx_resume_ranging() is enough.
+ * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
+ * @param (VL53L5CX_Profile) *p_current : Profile currently applied. It is
+ * updated with the new profile if the switch is OK.
+ * @param (VL53L5CX_Profile) *p_new : Profile to apply.
+ * @return (uint8_t) status : 0 if OK
+ */
+
+uint8_t vl53l5cx_apply_profile(
+		VL53L5CX_Configuration		*p_dev,
+		VL53L5CX_Profile		*p_current,
+		VL53L5CX_Profile		*p_new);
@@ -62,6 +62,48 @@
 
 #include "vl53l5cx_plugin_detection_thresholds.h"
 
+/* Thresholds are sent with the 12 bytes of DCI header and footer */
+static_assert(VL53L5CX_NB_THRESHOLDS * sizeof(VL53L5CX_DetectionThresholds)
+		+ 12U <= VL53L5CX_TEMPORARY_BUFFER_SIZE,
+		"VL53L5CX temporary buffer is too small for the thresholds");
+
+int32_t vl53l5cx_detection_thresholds_scale(
+		uint8_t				measurement)
+{
+	int32_t scale;
+
+	switch(measurement)
+	{
+		case VL53L5CX_DISTANCE_MM:
+			scale = 4;
+			break;
+		case VL53L5CX_SIGNAL_PER_SPAD_KCPS:
+			scale = 2048;
+			break;
+		case VL53L5CX_RANGE_SIGMA_MM:
+			scale = 128;
+			break;
+		case VL53L5CX_AMBIENT_PER_SPAD_KCPS:
+			scale = 2048;
+			break;
+		case VL53L5CX_NB_SPADS_ENABLED:
+			scale = 256;
+			break;
+		case VL53L5CX_MOTION_INDICATOR:
+			scale = 65535;
+			break;
+		case VL53L5CX_NB_TARGET_DETECTED:
+		case VL53L5CX_TARGET_STATUS:
+			scale = 1;
+			break;
+		default:
+			scale = 0;
+			break;
+	}
+
+	return scale;
+}
+
 uint8_t vl53l5cx_get_detection_thresholds_enable(
 		VL53L5CX_Configuration		*p_dev,
 		uint8_t				*p_enabled)
@@ -111,6 +153,7 @@ uint8_t vl53l5cx_get_detection_thresholds(
 		VL53L5CX_DetectionThresholds	*p_thresholds)
 {
 	uint8_t i, status = VL53L5CX_STATUS_OK;
+	int32_t scale;
 
 	/* Get thresholds configuration */
 	status |= vl53l5cx_dci_read_data(p_dev, (uint8_t*)p_thresholds,
@@ -120,34 +163,12 @@ uint8_t vl53l5cx_get_detection_thresholds(
 
 	for(i = 0; i < (uint8_t)VL53L5CX_NB_THRESHOLDS; i++)
 	{
-		switch(p_thresholds->measurement)
+		scale = vl53l5cx_detection_thresholds_scale(
+				p_thresholds[i].measurement);
+		if(scale > 1)
 		{
-			case VL53L5CX_DISTANCE_MM:
-				p_thresholds[i].param_low_thresh  /= 4;
-				p_thresholds[i].param_high_thresh /= 4;
-				break;
-			case VL53L5CX_SIGNAL_PER_SPAD_KCPS:
-				p_thresholds[i].param_low_thresh  /= 2048;
-				p_thresholds[i].param_high_thresh /= 2048;
-				break;
-			case VL53L5CX_RANGE_SIGMA_MM:
-				p_thresholds[i].param_low_thresh  /= 128;
-				p_thresholds[i].param_high_thresh /= 128;
-				break;
-			case VL53L5CX_AMBIENT_PER_SPAD_KCPS:
-				p_thresholds[i].param_low_thresh  /= 2048;
-				p_thresholds[i].param_high_thresh /= 2048;
-				break;
-			case VL53L5CX_NB_SPADS_ENABLED:
-				p_thresholds[i].param_low_thresh  /= 256;
-				p_thresholds[i].param_high_thresh /= 256;
-				break;
-			case VL53L5CX_MOTION_INDICATOR:
-				p_thresholds[i].param_low_thresh  /= 65535;
-				p_thresholds[i].param_high_thresh /= 65535;
-				break;
-			default:
-				break;
+			p_thresholds[i].param_low_thresh  /= scale;
+			p_thresholds[i].param_high_thresh /= scale;
 		}
 	}
 
@@ -159,39 +180,18 @@ uint8_t vl53l5cx_set_detection_thresholds(
 		VL53L5CX_DetectionThresholds	*p_thresholds)
 {
 	uint8_t i, status = VL53L5CX_STATUS_OK;
+	int32_t scale;
 	uint8_t grp_valid_target_cfg[] = {0x05, 0x05, 0x05, 0x05,
 					0x05, 0x05, 0x05, 0x05};
 
 	for(i = 0; i < (uint8_t) VL53L5CX_NB_THRESHOLDS; i++)
 	{
-		switch(p_thresholds->measurement)
+		scale = vl53l5cx_detection_thresholds_scale(
+				p_thresholds[i].measurement);
+		if(scale > 1)
 		{
-			case VL53L5CX_DISTANCE_MM:
-				p_thresholds[i].param_low_thresh  *= 4;
-				p_thresholds[i].param_high_thresh *= 4;
-				break;
-			case VL53L5CX_SIGNAL_PER_SPAD_KCPS:
-				p_thresholds[i].param_low_thresh  *= 2048;
-				p_thresholds[i].param_high_thresh *= 2048;
-				break;
-			case VL53L5CX_RANGE_SIGMA_MM:
-				p_thresholds[i].param_low_thresh  *= 128;
-				p_thresholds[i].param_high_thresh *= 128;
-				break;
-			case VL53L5CX_AMBIENT_PER_SPAD_KCPS:
-				p_thresholds[i].param_low_thresh  *= 2048;
-				p_thresholds[i].param_high_thresh *= 2048;
-				break;
-			case VL53L5CX_NB_SPADS_ENABLED:
-				p_thresholds[i].param_low_thresh  *= 256;
-				p_thresholds[i].param_high_thresh *= 256;
-				break;
-			case VL53L5CX_MOTION_INDICATOR:
-				p_thresholds[i].param_low_thresh  *= 65535;
-				p_thresholds[i].param_high_thresh *= 65535;
-				break;
-			default:
-				break;
+			p_thresholds[i].param_low_thresh  *= scale;
+			p_thresholds[i].param_high_thresh *= scale;
 		}
 	}
 
@@ -206,5 +206,267 @@ uint8_t vl53l5cx_set_detection_thresholds(
 			(uint16_t)(VL53L5CX_NB_THRESHOLDS
 			*sizeof(VL53L5CX_DetectionThresholds)));
 
+	/* Give the user array back in user units */
+	for(i = 0; i < (uint8_t) VL53L5CX_NB_THRESHOLDS; i++)
+	{
+		scale = vl53l5cx_detection_thresholds_scale(
+				p_thresholds[i].measurement);
+		if(scale > 1)
+		{
+			p_thresholds[i].param_low_thresh  /= scale;
+			p_thresholds[i].param_high_thresh /= scale;
+		}
+	}
+
+	return status;
+}
+
+/**
+ * @brief Inner function, not available outside this file. This function gets
+ * a threshold of a set, in host byte order.
+ */
+
+static void _vl53l5cx_threshold_entry(
+		const VL53L5CX_DetectionThresholdsSet	*p_set,
+		uint8_t					i,
+		VL53L5CX_DetectionThresholds		*p_entry)
+{
+	(void)memcpy(p_entry, &p_set->wire[(uint16_t)i
+			* (uint16_t)sizeof(VL53L5CX_DetectionThresholds)],
+			sizeof(VL53L5CX_DetectionThresholds));
+	vl53l5cx_swap_buffer((uint8_t*)p_entry,
+			(uint16_t)sizeof(VL53L5CX_DetectionThresholds));
+}
+
+uint8_t vl53l5cx_compile_detection_thresholds(
+		const VL53L5CX_DetectionThresholds	*p_thresholds,
+		VL53L5CX_DetectionThresholdsSet		*p_set)
+{
+	uint8_t i, last_found = 0, status = VL53L5CX_STATUS_OK;
+	int32_t scale, limit;
+	const VL53L5CX_DetectionThresholds *p_in;
+	VL53L5CX_DetectionThresholds out;
+
+	(void)memcpy(p_set->wire, p_thresholds, sizeof(p_set->wire));
+	p_set->uploaded = 0;
+
+	for(i = 0; (i < (uint8_t)VL53L5CX_NB_THRESHOLDS)
+			&& (last_found == (uint8_t)0); i++)
+	{
+		p_in = &p_thresholds[i];
+
+		scale = vl53l5cx_detection_thresholds_scale(p_in->measurement);
+		limit = (int32_t)0x7FFFFFFF / ((scale > 0) ? scale : 1);
+
+		if((scale == 0)
+			|| (p_in->type > VL53L5CX_NOT_EQUAL_MIN_CHECKER)
+			|| ((p_in->zone_num & (uint8_t)0x7F)
+				>= (uint8_t)VL53L5CX_NB_THRESHOLDS)
+			|| ((p_in->mathematic_operation != VL53L5CX_OPERATION_OR)
+			  && (p_in->mathematic_operation != VL53L5CX_OPERATION_AND))
+			|| ((i == (uint8_t)0) && (p_in->mathematic_operation
+				!= VL53L5CX_OPERATION_OR))
+			|| (p_in->param_low_thresh > limit)
+			|| (p_in->param_low_thresh < -limit)
+			|| (p_in->param_high_thresh > limit)
+			|| (p_in->param_high_thresh < -limit))
+		{
+			status |= VL53L5CX_STATUS_INVALID_PARAM;
+			break;
+		}
+
+		out = *p_in;
+		out.param_low_thresh = p_in->param_low_thresh * scale;
+		out.param_high_thresh = p_in->param_high_thresh * scale;
+		(void)memcpy(&p_set->wire[(uint16_t)i
+				* (uint16_t)sizeof(VL53L5CX_DetectionThresholds)],
+				&out, sizeof(out));
+
+		if((p_in->zone_num & VL53L5CX_LAST_THRESHOLD) != (uint8_t)0)
+		{
+			last_found = 1;
+		}
+	}
+
+	/* Convert once to firmware format, so that uploads send the set as is */
+	vl53l5cx_swap_buffer(p_set->wire, (uint16_t)sizeof(p_set->wire));
+
+	return status;
+}
+
+uint8_t vl53l5cx_upload_detection_thresholds(
+		VL53L5CX_Configuration			*p_dev,
+		VL53L5CX_DetectionThresholdsSet		*p_current,
+		const VL53L5CX_DetectionThresholdsSet	*p_new)
+{
+	uint8_t status = VL53L5CX_STATUS_OK;
+	uint8_t grp_valid_target_cfg[] = {0x05, 0x05, 0x05, 0x05,
+					0x05, 0x05, 0x05, 0x05};
+
+	if(p_current->uploaded == (uint8_t)0)
+	{
+		/* Set valid target list, only needed once */
+		status |= vl53l5cx_dci_write_data(p_dev,
+				(uint8_t*)grp_valid_target_cfg,
+				VL53L5CX_DCI_DET_THRESH_VALID_STATUS, 
+				(uint16_t)sizeof(grp_valid_target_cfg));
+	}
+	else if(memcmp(p_current->wire, p_new->wire,
+				sizeof(p_new->wire)) == 0)
+	{
+		/* Already on the sensor */
+		return status;
+	}
+
+	/* Set thresholds configuration, as one block */
+	status |= vl53l5cx_dci_write_wire_data(p_dev, p_new->wire,
+			VL53L5CX_DCI_DET_THRESH_START,
+			(uint16_t)sizeof(p_new->wire));
+
+	if(status == VL53L5CX_STATUS_OK)
+	{
+		(void)memcpy(p_current->wire, p_new->wire,
+				sizeof(p_current->wire));
+		p_current->uploaded = 1;
+	}
+
+	return status;
+}
+
+/**
+ * @brief Inner function, not available outside this file. This function gets
+ * the value of a zone for a threshold measurement, in user units.
+ */
+
+static uint8_t _vl53l5cx_threshold_value(
+		const VL53L5CX_ResultsData	*p_results,
+		uint8_t				measurement,
+		uint8_t				zone,
+		int32_t				*p_value)
+{
+	uint8_t status = VL53L5CX_STATUS_OK;
+	uint16_t target = (uint16_t)zone
+		* (uint16_t)p_results->nb_target_per_zone;
+
+	switch(measurement)
+	{
+#ifndef VL53L5CX_DISABLE_DISTANCE_MM
+		case VL53L5CX_DISTANCE_MM:
+			*p_value = p_results->distance_mm[target];
+			break;
+#endif
+#ifndef VL53L5CX_DISABLE_SIGNAL_PER_SPAD
+		case VL53L5CX_SIGNAL_PER_SPAD_KCPS:
+			*p_value = (int32_t)p_results->signal_per_spad[target];
+			break;
+#endif
+#ifndef VL53L5CX_DISABLE_RANGE_SIGMA_MM
+		case VL53L5CX_RANGE_SIGMA_MM:
+			*p_value = p_results->range_sigma_mm[target];
+			break;
+#endif
+#ifndef VL53L5CX_DISABLE_AMBIENT_PER_SPAD
+		case VL53L5CX_AMBIENT_PER_SPAD_KCPS:
+			*p_value = (int32_t)p_results->ambient_per_spad[zone];
+			break;
+#endif
+#ifndef VL53L5CX_DISABLE_NB_TARGET_DETECTED
+		case VL53L5CX_NB_TARGET_DETECTED:
+			*p_value = p_results->nb_target_detected[zone];
+			break;
+#endif
+#ifndef VL53L5CX_DISABLE_TARGET_STATUS
+		case VL53L5CX_TARGET_STATUS:
+			*p_value = p_results->target_status[target];
+			break;
+#endif
+#ifndef VL53L5CX_DISABLE_NB_SPADS_ENABLED
+		case VL53L5CX_NB_SPADS_ENABLED:
+			*p_value = (int32_t)p_results->nb_spads_enabled[zone];
+			break;
+#endif
+#ifndef VL53L5CX_DISABLE_MOTION_INDICATOR
+		case VL53L5CX_MOTION_INDICATOR:
+			if(zone < (uint8_t)32)
+			{
+				*p_value = (int32_t)p_results
+					->motion_indicator.motion[zone];
+			}
+			else
+			{
+				status = VL53L5CX_STATUS_ERROR;
+			}
+			break;
+#endif
+		default:
+			status = VL53L5CX_STATUS_ERROR;
+			break;
+	}
+
+	return status;
+}
+
+uint8_t vl53l5cx_check_detection_thresholds(
+		const VL53L5CX_DetectionThresholdsSet	*p_set,
+		const VL53L5CX_ResultsData		*p_results,
+		uint64_t				*p_fired)
+{
+	uint8_t i, met, status = VL53L5CX_STATUS_OK;
+	int32_t scale, low, high, value;
+	VL53L5CX_DetectionThresholds entry;
+	const VL53L5CX_DetectionThresholds *p_thr = &entry;
+
+	*p_fired = 0;
+
+	for(i = 0; i < (uint8_t)VL53L5CX_NB_THRESHOLDS; i++)
+	{
+		_vl53l5cx_threshold_entry(p_set, i, &entry);
+		scale = vl53l5cx_detection_thresholds_scale(p_thr->measurement);
+
+		if((scale != 0) && (_vl53l5cx_threshold_value(p_results,
+				p_thr->measurement,
+				p_thr->zone_num & (uint8_t)0x7F, &value)
+					== VL53L5CX_STATUS_OK))
+		{
+			low = p_thr->param_low_thresh / scale;
+			high = p_thr->param_high_thresh / scale;
+
+			switch(p_thr->type)
+			{
+				case VL53L5CX_IN_WINDOW:
+					met = (value >= low) && (value <= high);
+					break;
+				case VL53L5CX_OUT_OF_WINDOW:
+					met = (value < low) || (value > high);
+					break;
+				case VL53L5CX_LESS_THAN_EQUAL_MIN_CHECKER:
+					met = value <= low;
+					break;
+				case VL53L5CX_GREATER_THAN_MAX_CHECKER:
+					met = value > high;
+					break;
+				case VL53L5CX_EQUAL_MIN_CHECKER:
+					met = value == low;
+					break;
+				case VL53L5CX_NOT_EQUAL_MIN_CHECKER:
+					met = value != low;
+					break;
+				default:
+					met = 0;
+					break;
+			}
+
+			if(met != (uint8_t)0)
+			{
+				*p_fired |= (uint64_t)1 << i;
+			}
+		}
+
+		if((p_thr->zone_num & VL53L5CX_LAST_THRESHOLD) != (uint8_t)0)
+		{
+			break;
+		}
+	}
+
 	return status;
 }
@@ -148,6 +148,24 @@ typedef struct {
 	uint8_t		mathematic_operation;
 }VL53L5CX_DetectionThresholds;
 
+/**
+ * @brief Structure VL53L5CX_DetectionThresholdsSet contains 64 thresholds
+ * already validated, scaled into firmware units and converted to firmware byte
+ * order, as built by vl53l5cx_compile_detection_thresholds(). The DCI block is
+ * sent as is and never modified by the upload. The same structure is used to
+ * cache what has been uploaded to the sensor, so that
+ * vl53l5cx_upload_detection_thresholds() only sends a set which changed.
+ */
+
+typedef struct {
+
+	/* DCI block of the scaled thresholds, in firmware byte order */
+	uint8_t		wire[VL53L5CX_NB_THRESHOLDS
+				* sizeof(VL53L5CX_DetectionThresholds)];
+	/* Set to 1 once the block mirrors the sensor content */
+	uint8_t		uploaded;
+}VL53L5CX_DetectionThresholdsSet;
+
 /**
  * @brief This function allows indicating if the detection thresholds are
  * enabled.
@@ -183,7 +201,9 @@ uint8_t vl53l5cx_get_detection_thresholds(
 		VL53L5CX_DetectionThresholds	*p_thresholds);
 
 /**
- * @brief This function allows programming the detection thresholds.
+ * @brief This function allows programming the detection thresholds. Each entry
+ * is scaled according to its own measurement; the array is restored before
+ * returning.
  * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
  * @param (VL53L5CX_DetectionThresholds) *p_thresholds :  Array of 64 thresholds.
  * @return (uint8_t) status : 0 if programming is OK
@@ -193,4 +213,62 @@ uint8_t vl53l5cx_set_detection_thresholds(
 		VL53L5CX_Configuration		*p_dev,
 		VL53L5CX_DetectionThresholds	*p_thresholds);
 
+/**
+ * @brief This function validates an array of 64 thresholds and scales each entry
+ * according to its own measurement into a thresholds set. The input array is
+ * not modified. Entries after the one flagged with VL53L5CX_LAST_THRESHOLD are
+ * not checked.
+ * @param (VL53L5CX_DetectionThresholds) *p_thresholds : Array of 64 thresholds.
+ * @param (VL53L5CX_DetectionThresholdsSet) *p_set : Compiled thresholds.
+ * @return (uint8_t) status : 0 if OK, or 127 if a threshold is invalid or
+ * cannot be scaled without overflow.
+ */
+
+uint8_t vl53l5cx_compile_detection_thresholds(
+		const VL53L5CX_DetectionThresholds	*p_thresholds,
+		VL53L5CX_DetectionThresholdsSet		*p_set);
+
+/**
+ * @brief This function uploads a compiled thresholds set, as a single DCI write
+ * of the whole block. Nothing is sent if the set is the one currently on the
+ * sensor.
+ * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
+ * @param (VL53L5CX_DetectionThresholdsSet) *p_current : Set currently on the
+ * sensor. Its 'uploaded' field must be 0 before the first upload, so that the
+ * set is always sent. It is updated with the new set.
+ * @param (VL53L5CX_DetectionThresholdsSet) *p_new : Set to upload.
+ * @return (uint8_t) status : 0 if programming is OK
+ */
+
+uint8_t vl53l5cx_upload_detection_thresholds(
+		VL53L5CX_Configuration			*p_dev,
+		VL53L5CX_DetectionThresholdsSet		*p_current,
+		const VL53L5CX_DetectionThresholdsSet	*p_new);
+
+/**
+ * @brief This function returns the factor between user units and firmware
+ * units for a threshold measurement.
+ * @param (uint8_t) measurement : Measurement (VL53L5CX_DISTANCE_MM, ...).
+ * @return (int32_t) scale : Factor, or 0 if the measurement is unknown.
+ */
+
+int32_t vl53l5cx_detection_thresholds_scale(
+		uint8_t				measurement);
+
+/**
+ * @brief This function checks a ranging frame against a compiled thresholds
+ * set, on the host side. It is used after a threshold interrupt to know which
+ * thresholds fired. Measurements disabled at compile time never fire.
+ * @param (VL53L5CX_DetectionThresholdsSet) *p_set : Thresholds programmed into
+ * the sensor.
+ * @param (VL53L5CX_ResultsData) *p_results : Frame read after the interrupt.
+ * @param (uint64_t) *p_fired : Bit i is set if threshold i is met.
+ * @return (uint8_t) status : 0 if OK
+ */
+
+uint8_t vl53l5cx_check_detection_thresholds(
+		const VL53L5CX_DetectionThresholdsSet	*p_set,
+		const VL53L5CX_ResultsData		*p_results,
+		uint64_t				*p_fired);
+
 #endif /* VL53L5CX_PLUGIN_DETECTION_THRESHOLDS_H_ */
@@ -63,6 +63,11 @@
 #include <math.h> 
 #include "vl53l5cx_plugin_motion_indicator.h"
 
+/* The configuration is sent with the 12 bytes of DCI header and footer */
+static_assert(sizeof(VL53L5CX_Motion_Configuration) + 12U
+		<= VL53L5CX_TEMPORARY_BUFFER_SIZE,
+		"VL53L5CX temporary buffer is too small for the motion config");
+
 uint8_t vl53l5cx_motion_indicator_init(
 		VL53L5CX_Configuration		*p_dev,
 		VL53L5CX_Motion_Configuration	*p_motion_config,
@@ -70,6 +75,57 @@ uint8_t vl53l5cx_motion_indicator_init(
 {
 	uint8_t status = VL53L5CX_STATUS_OK;
 
+	status |= vl53l5cx_motion_indicator_config_init(p_motion_config);
+
+	status |= vl53l5cx_motion_indicator_set_resolution(p_dev,
+			p_motion_config, resolution);
+
+	return status;
+}
+
+uint8_t vl53l5cx_motion_indicator_set_distance_motion(
+		VL53L5CX_Configuration		*p_dev,
+		VL53L5CX_Motion_Configuration	*p_motion_config,
+		uint16_t			distance_min_mm,
+		uint16_t			distance_max_mm)
+{
+	uint8_t status = VL53L5CX_STATUS_OK;
+
+	status |= vl53l5cx_motion_indicator_config_set_distance(
+			p_motion_config, distance_min_mm, distance_max_mm);
+
+	if(status == (uint8_t)0)
+	{
+		status |= vl53l5cx_motion_indicator_set_config(p_dev,
+				p_motion_config);
+	}
+
+	return status;
+}
+
+uint8_t vl53l5cx_motion_indicator_set_resolution(
+		VL53L5CX_Configuration		*p_dev,
+		VL53L5CX_Motion_Configuration	*p_motion_config,
+		uint8_t				resolution)
+{
+	uint8_t status = VL53L5CX_STATUS_OK;
+
+	status |= vl53l5cx_motion_indicator_config_set_map(p_motion_config,
+			resolution);
+
+	/* Only send a valid map */
+	if(status == (uint8_t)0)
+	{
+		status |= vl53l5cx_motion_indicator_set_config(p_dev,
+				p_motion_config);
+	}
+
+	return status;
+}
+
+uint8_t vl53l5cx_motion_indicator_config_init(
+		VL53L5CX_Motion_Configuration	*p_motion_config)
+{
 	(void)memset(p_motion_config, 0, sizeof(VL53L5CX_Motion_Configuration));
 
 	p_motion_config->ref_bin_offset = 13633;
@@ -89,14 +145,10 @@ uint8_t vl53l5cx_motion_indicator_init(
 	p_motion_config->spare_2 = 0;
 	p_motion_config->spare_3 = 0;
 
-	status |= vl53l5cx_motion_indicator_set_resolution(p_dev,
-			p_motion_config, resolution);
-
-	return status;
+	return vl53l5cx_motion_indicator_config_clear_map(p_motion_config);
 }
 
-uint8_t vl53l5cx_motion_indicator_set_distance_motion(
-		VL53L5CX_Configuration		*p_dev,
+uint8_t vl53l5cx_motion_indicator_config_set_distance(
 		VL53L5CX_Motion_Configuration	*p_motion_config,
 		uint16_t			distance_min_mm,
 		uint16_t			distance_max_mm)
@@ -120,18 +172,12 @@ uint8_t vl53l5cx_motion_indicator_set_distance_motion(
 			(float_t)distance_min_mm)/(float_t)10.0)+(float_t)30.02784)
 			/((float_t)15.01392))+(float_t)0.5);
 		p_motion_config->feature_length = (uint8_t)tmp;
-
-		status |= vl53l5cx_dci_write_data(p_dev, 
-			(uint8_t*)(p_motion_config),
-			VL53L5CX_DCI_MOTION_DETECTOR_CFG,
-                        (uint16_t)sizeof(*p_motion_config));
 	}
 
 	return status;
 }
 
-uint8_t vl53l5cx_motion_indicator_set_resolution(
-		VL53L5CX_Configuration		*p_dev,
+uint8_t vl53l5cx_motion_indicator_config_set_map(
 		VL53L5CX_Motion_Configuration	*p_motion_config,
 		uint8_t				resolution)
 {
@@ -145,6 +191,7 @@ uint8_t vl53l5cx_motion_indicator_set_resolution(
 				p_motion_config->map_id[i] = (int8_t)i;
 			}
 		(void)memset(p_motion_config->map_id + 16, -1, 48);
+		p_motion_config->nb_of_aggregates = 16;
 		break;
 
 		case VL53L5CX_RESOLUTION_8X8:
@@ -153,20 +200,134 @@ uint8_t vl53l5cx_motion_indicator_set_resolution(
                                p_motion_config->map_id[i] = (int8_t)((((int8_t)
                                i % 8)/2) + (4*((int8_t)i/16)));
 			}
+		p_motion_config->nb_of_aggregates = 16;
 		break;
 
 		default:
-			status |= VL53L5CX_STATUS_ERROR;
+			status |= VL53L5CX_STATUS_INVALID_PARAM;
 		break;
 	}
 
-	if(status != (uint8_t)0)
+	return status;
+}
+
+uint8_t vl53l5cx_motion_indicator_config_clear_map(
+		VL53L5CX_Motion_Configuration	*p_motion_config)
+{
+	(void)memset(p_motion_config->map_id, -1,
+			sizeof(p_motion_config->map_id));
+	p_motion_config->nb_of_aggregates = 0;
+
+	return VL53L5CX_STATUS_OK;
+}
+
+uint8_t vl53l5cx_motion_indicator_config_add_roi(
+		VL53L5CX_Motion_Configuration	*p_motion_config,
+		uint8_t				resolution,
+		uint8_t				x_min,
+		uint8_t				y_min,
+		uint8_t				x_max,
+		uint8_t				y_max,
+		uint8_t				*p_aggregate_id)
+{
+	uint8_t x, y, width, zone, status = VL53L5CX_STATUS_OK;
+	const int8_t id = (int8_t)p_motion_config->nb_of_aggregates;
+
+	width = (resolution == VL53L5CX_RESOLUTION_4X4) ? (uint8_t)4 : (uint8_t)8;
+
+	if(((resolution != VL53L5CX_RESOLUTION_4X4)
+			&& (resolution != VL53L5CX_RESOLUTION_8X8))
+		|| (x_min > x_max) || (y_min > y_max)
+		|| (x_max >= width) || (y_max >= width)
+		|| (p_motion_config->nb_of_aggregates
+			>= VL53L5CX_MOTION_MAX_AGGREGATES))
+	{
+		status |= VL53L5CX_STATUS_INVALID_PARAM;
+	}
+	else
+	{
+		/* Check first, so that a failed call leaves the map untouched */
+		for(y = y_min; y <= y_max; y++)
+		{
+			for(x = x_min; x <= x_max; x++)
+			{
+				zone = (uint8_t)((y * width) + x);
+				if(p_motion_config->map_id[zone] != (int8_t)-1)
+				{
+					status |= VL53L5CX_STATUS_INVALID_PARAM;
+				}
+			}
+		}
+	}
+
+	if(status == (uint8_t)0)
+	{
+		for(y = y_min; y <= y_max; y++)
+		{
+			for(x = x_min; x <= x_max; x++)
+			{
+				zone = (uint8_t)((y * width) + x);
+				p_motion_config->map_id[zone] = id;
+			}
+		}
+
+		p_motion_config->nb_of_aggregates++;
+
+		if(p_aggregate_id != NULL)
+		{
+			*p_aggregate_id = (uint8_t)id;
+		}
+	}
+
+	return status;
+}
+
+uint8_t vl53l5cx_motion_indicator_config_add_rows(
+		VL53L5CX_Motion_Configuration	*p_motion_config,
+		uint8_t				resolution)
+{
+	uint8_t y, width, status = VL53L5CX_STATUS_OK;
+
+	width = (resolution == VL53L5CX_RESOLUTION_4X4) ? (uint8_t)4 : (uint8_t)8;
+
+	for(y = 0; (y < width) && (status == (uint8_t)0); y++)
+	{
+		status |= vl53l5cx_motion_indicator_config_add_roi(
+				p_motion_config, resolution,
+				0, y, width - (uint8_t)1, y, NULL);
+	}
+
+	return status;
+}
+
+uint8_t vl53l5cx_motion_indicator_config_add_columns(
+		VL53L5CX_Motion_Configuration	*p_motion_config,
+		uint8_t				resolution)
+{
+	uint8_t x, width, status = VL53L5CX_STATUS_OK;
+
+	width = (resolution == VL53L5CX_RESOLUTION_4X4) ? (uint8_t)4 : (uint8_t)8;
+
+	for(x = 0; (x < width) && (status == (uint8_t)0); x++)
 	{
-		status |= vl53l5cx_dci_write_data(p_dev, 
-				(uint8_t*)(p_motion_config),
-				VL53L5CX_DCI_MOTION_DETECTOR_CFG, 
-                                (uint16_t)sizeof(*p_motion_config));
+		status |= vl53l5cx_motion_indicator_config_add_roi(
+				p_motion_config, resolution,
+				x, 0, x, width - (uint8_t)1, NULL);
 	}
 
 	return status;
 }
+
+uint8_t vl53l5cx_motion_indicator_set_config(
+		VL53L5CX_Configuration		*p_dev,
+		VL53L5CX_Motion_Configuration	*p_motion_config)
+{
+	uint8_t status = VL53L5CX_STATUS_OK;
+
+	status |= vl53l5cx_dci_write_data(p_dev, 
+			(uint8_t*)(p_motion_config),
+			VL53L5CX_DCI_MOTION_DETECTOR_CFG,
+			(uint16_t)sizeof(*p_motion_config));
+
+	return status;
+}
@@ -145,4 +145,115 @@ uint8_t vl53l5cx_motion_indicator_set_resolution(
 		VL53L5CX_Motion_Configuration	*p_motion_config,
 		uint8_t				resolution);
 
+/**
+ * @brief Macro VL53L5CX_MOTION_MAX_AGGREGATES indicates the maximum number of
+ * aggregates, which is also the size of the motion results array.
+ */
+
+#define VL53L5CX_MOTION_MAX_AGGREGATES		((uint8_t)32U)
+
+/**
+ * @brief The following functions build a motion indicator configuration
+ * without any I2C access. The configuration is then sent in a single DCI write
+ * using vl53l5cx_motion_indicator_set_config().
+ */
+
+/**
+ * @brief This function fills a configuration with the default parameters
+ * (same as vl53l5cx_motion_indicator_init()) and an empty map: no zone
+ * belongs to an aggregate.
+ * @param (VL53L5CX_Motion_Configuration) *p_motion_config : Configuration.
+ * @return (uint8_t) status : 0 if OK
+ */
+
+uint8_t vl53l5cx_motion_indicator_config_init(
+		VL53L5CX_Motion_Configuration	*p_motion_config);
+
+/**
+ * @brief This function sets the working distance of a configuration, with the
+ * same limits as vl53l5cx_motion_indicator_set_distance_motion().
+ * @param (VL53L5CX_Motion_Configuration) *p_motion_config : Configuration.
+ * @param (uint16_t) distance_min_mm : Minimum distance for indicator.
+ * @param (uint16_t) distance_max_mm : Maximum distance for indicator.
+ * @return (uint8_t) status : 0 if OK, or 127 if an argument is invalid.
+ */
+
+uint8_t vl53l5cx_motion_indicator_config_set_distance(
+		VL53L5CX_Motion_Configuration	*p_motion_config,
+		uint16_t			distance_min_mm,
+		uint16_t			distance_max_mm);
+
+/**
+ * @brief This function sets the default map of a resolution: one aggregate
+ * per zone in 4x4, and one aggregate per 2x2 zones in 8x8.
+ * @param (VL53L5CX_Motion_Configuration) *p_motion_config : Configuration.
+ * @param (uint8_t) resolution : VL53L5CX_RESOLUTION_4X4 or
+ * VL53L5CX_RESOLUTION_8X8.
+ * @return (uint8_t) status : 0 if OK, or 127 is the resolution is unknown.
+ */
+
+uint8_t vl53l5cx_motion_indicator_config_set_map(
+		VL53L5CX_Motion_Configuration	*p_motion_config,
+		uint8_t				resolution);
+
+/**
+ * @brief This function removes all aggregates from the map.
+ * @param (VL53L5CX_Motion_Configuration) *p_motion_config : Configuration.
+ * @return (uint8_t) status : 0 if OK
+ */
+
+uint8_t vl53l5cx_motion_indicator_config_clear_map(
+		VL53L5CX_Motion_Configuration	*p_motion_config);
+
+/**
+ * @brief This function adds an aggregate made of a rectangle of zones. Zone
+ * (x, y) is the zone number y*width + x, as in the ranging results.
+ * @param (VL53L5CX_Motion_Configuration) *p_motion_config : Configuration.
+ * @param (uint8_t) resolution : VL53L5CX_RESOLUTION_4X4 or
+ * VL53L5CX_RESOLUTION_8X8.
+ * @param (uint8_t) x_min, y_min, x_max, y_max : Included bounds of the ROI.
+ * @param (uint8_t) *p_aggregate_id : Index of the new aggregate in the motion
+ * results. Can be NULL.
+ * @return (uint8_t) status : 0 if OK, or 127 if the ROI is out of the grid,
+ * overlaps another aggregate, or if there are already 32 aggregates.
+ */
+
+uint8_t vl53l5cx_motion_indicator_config_add_roi(
+		VL53L5CX_Motion_Configuration	*p_motion_config,
+		uint8_t				resolution,
+		uint8_t				x_min,
+		uint8_t				y_min,
+		uint8_t				x_max,
+		uint8_t				y_max,
+		uint8_t				*p_aggregate_id);
+
+/**
+ * @brief These functions add one aggregate per row, or per column, of the
+ * grid. They fail if a zone already belongs to an aggregate.
+ * @param (VL53L5CX_Motion_Configuration) *p_motion_config : Configuration.
+ * @param (uint8_t) resolution : VL53L5CX_RESOLUTION_4X4 or
+ * VL53L5CX_RESOLUTION_8X8.
+ * @return (uint8_t) status : 0 if OK, or 127 if an argument is invalid.
+ */
+
+uint8_t vl53l5cx_motion_indicator_config_add_rows(
+		VL53L5CX_Motion_Configuration	*p_motion_config,
+		uint8_t				resolution);
+
+uint8_t vl53l5cx_motion_indicator_config_add_columns(
+		VL53L5CX_Motion_Configuration	*p_motion_config,
+		uint8_t				resolution);
+
+/**
+ * @brief This function sends a configuration to the sensor, using a single DCI
+ * write. The sensor must not be streaming.
+ * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
+ * @param (VL53L5CX_Motion_Configuration) *p_motion_config : Configuration.
+ * @return (uint8_t) status : 0 if OK
+ */
+
+uint8_t vl53l5cx_motion_indicator_set_config(
+		VL53L5CX_Configuration		*p_dev,
+		VL53L5CX_Motion_Configuration	*p_motion_config);
+
 #endif /* VL53L5CX_PLUGIN_MOTION_INDICATOR_H_ */
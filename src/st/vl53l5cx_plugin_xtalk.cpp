@@ -62,6 +62,11 @@
 
 #include "vl53l5cx_plugin_xtalk.h"
 
+/* Calibration data is read with its 4-byte header */
+static_assert(VL53L5CX_XTALK_BUFFER_SIZE + 4U
+		<= VL53L5CX_TEMPORARY_BUFFER_SIZE,
+		"VL53L5CX temporary buffer is too small for the xtalk data");
+
 extern void delay(const uint32_t msec);
 
 /*
@@ -77,6 +82,9 @@ static uint8_t _vl53l5cx_poll_for_answer(
 	uint8_t status = VL53L5CX_STATUS_OK;
 	uint8_t timeout = 0;
 
+	/* The last frame read into the scratch is lost */
+	p_dev->p_scratch->p_frame_owner = NULL;
+
 	do {
 		status |= VL53L1CX_ReadMulti(&(p_dev->platform), 
                                   address, p_dev->temp_buffer, 4);
@@ -191,6 +199,20 @@ static uint8_t _vl53l5cx_program_output_config(
 	return status;
 }
 
+uint8_t vl53l5cx_set_xtalk_storage(
+		VL53L5CX_Configuration		*p_dev,
+		uint8_t				*p_xtalk_storage)
+{
+	if(p_xtalk_storage == NULL)
+	{
+		return VL53L5CX_STATUS_INVALID_PARAM;
+	}
+
+	p_dev->p_xtalk_storage = p_xtalk_storage;
+
+	return VL53L5CX_STATUS_OK;
+}
+
 uint8_t vl53l5cx_calibrate_xtalk(
 		VL53L5CX_Configuration		*p_dev,
 		uint16_t			reflectance_percent,
@@ -209,6 +231,12 @@ uint8_t vl53l5cx_calibrate_xtalk(
 	uint8_t	samples = nb_samples;
 	uint16_t distance = distance_mm;
 
+	/* The calibration is kept in the xtalk storage of the device */
+	if(p_dev->p_xtalk_storage == NULL)
+	{
+		return VL53L5CX_STATUS_INVALID_PARAM;
+	}
+
 	/* Get initial configuration */
 	status |= vl53l5cx_get_resolution(p_dev, &resolution);
 	status |= vl53l5cx_get_ranging_frequency_hz(p_dev, &frequency);
@@ -277,7 +305,8 @@ uint8_t vl53l5cx_calibrate_xtalk(
 				(((uint16_t)(p_dev->temp_buffer[3] & 
                                  (uint16_t)0x80) >> 7) == (uint16_t)1))
 				{
-					(void)memcpy(p_dev->xtalk_data, 
+					(void)memcpy(
+                                               p_dev->p_xtalk_storage,
                                                p_dev->default_xtalk,
                                                VL53L5CX_XTALK_BUFFER_SIZE);
 				}
@@ -308,10 +337,12 @@ uint8_t vl53l5cx_calibrate_xtalk(
             p_dev->temp_buffer, 
             VL53L5CX_XTALK_BUFFER_SIZE + (uint16_t)4);
 
-    (void)memcpy(&(p_dev->xtalk_data[0]), &(p_dev->temp_buffer[8]),
+    (void)memcpy(&(p_dev->p_xtalk_storage[0]),
+            &(p_dev->temp_buffer[8]),
             VL53L5CX_XTALK_BUFFER_SIZE - (uint16_t)8);
-    (void)memcpy(&(p_dev->xtalk_data[VL53L5CX_XTALK_BUFFER_SIZE 
+    (void)memcpy(&(p_dev->p_xtalk_storage[VL53L5CX_XTALK_BUFFER_SIZE 
                 - (uint16_t)8]), footer, sizeof(footer));
+    p_dev->p_xtalk_data = p_dev->p_xtalk_storage;
 
     /* Reset default buffer */
     status |= VL53L1CX_WriteMulti(&(p_dev->platform), 0x2c34,
@@ -366,8 +397,15 @@ uint8_t vl53l5cx_set_caldata_xtalk(
 {
     uint8_t resolution, status = VL53L5CX_STATUS_OK;
 
+    if(p_dev->p_xtalk_storage == NULL)
+    {
+        return VL53L5CX_STATUS_INVALID_PARAM;
+    }
+
     status |= vl53l5cx_get_resolution(p_dev, &resolution);
-    (void)memcpy(p_dev->xtalk_data, p_xtalk_data, VL53L5CX_XTALK_BUFFER_SIZE);
+    (void)memcpy(p_dev->p_xtalk_storage, p_xtalk_data,
+            VL53L5CX_XTALK_BUFFER_SIZE);
+    p_dev->p_xtalk_data = p_dev->p_xtalk_storage;
     status |= vl53l5cx_set_resolution(p_dev, resolution);
 
     return status;
@@ -20,6 +20,23 @@
 #define VL53L5CX_DCI_XTALK_CFG				((uint16_t)0xAD94U)
 
 
+/**
+ * @brief This function selects the buffer where the Xtalk calibration of the
+ * device is kept, and sent from whenever the resolution changes. It must be
+ * called after vl53l5cx_set_calibration(), and before
+ * vl53l5cx_calibrate_xtalk() or vl53l5cx_set_caldata_xtalk(), which return 127
+ * without it. Devices which never calibrate Xtalk use the default Xtalk of the
+ * driver, and need no storage.
+ * @param (VL53L5CX_Configuration) *p_dev : VL53L5CX configuration structure.
+ * @param (uint8_t) *p_xtalk_storage : Buffer of VL53L5CX_XTALK_BUFFER_SIZE
+ * bytes, which must outlive the device.
+ * @return (uint8_t) status : 0 if OK, or 127 if p_xtalk_storage is NULL.
+ */
+
+uint8_t vl53l5cx_set_xtalk_storage(
+		VL53L5CX_Configuration		*p_dev,
+		uint8_t				*p_xtalk_storage);
+
 /**
  * This function starts the VL53L5CX sensor in order to calibrate Xtalk.
  * This calibration is recommended is user wants to use a coverglass.
@@ -37,7 +54,8 @@
  * so short distance are easier for calibration.
  *
  * @return (uint8_t) status : 0 if calibration OK, 127 if an argument has an
- * incorrect value, or 255 is something failed.
+ * incorrect value or no Xtalk storage was selected, or 255 is something
+ * failed.
  */
 
 uint8_t vl53l5cx_calibrate_xtalk(
@@ -65,7 +83,8 @@ uint8_t vl53l5cx_get_caldata_xtalk(
  * @param (VL53L5CX_Configuration) *p_dev : VL53L5 configuration structure.
  * @param (uint8_t) *p_xtalk_data : Buffer with a size defined by
  * macro VL53L5CX_XTALK_SIZE.
- * @return (uint8_t) status : 0 if buffer OK
+ * @return (uint8_t) status : 0 if buffer OK, or 127 if no Xtalk storage was
+ * selected.
  */
 
 uint8_t vl53l5cx_set_caldata_xtalk(
@@ -9,9 +9,15 @@
 #pragma once
 
 #include "debugger.hpp"
+#include "vl53l5cx_frame_channel.hpp"
+#include "vl53l5cx_frame_pool.hpp"
+#include "vl53l5cx_frame_ring.hpp"
+#include "vl53l5cx_frame_view.hpp"
+#include "vl53l5cx_latest_frame.hpp"
 
 #include "st/vl53l5cx_api.h"
 #include "st/vl53l5cx_plugin_detection_thresholds.h"
+#include "st/vl53l5cx_plugin_motion_indicator.h"
 
 #include <stdint.h>
 
@@ -126,6 +132,10 @@ class VL53L5CX {
             disable();
             enable();
 
+            // Thresholds are lost by the reset
+            m_thresholds.uploaded = 0;
+            m_thresholdsEnabled = false;
+
             // Check if there is a VL53L5CX sensor connected
             uint8_t isAlive = 0;
 
@@ -144,6 +154,15 @@ class VL53L5CX {
             Debugger::printf("VL53L5CX ULD ready ! (Version : %s)\n", 
                     VL53L5CX_API_REVISION);
 
+            checkStatus(vl53l5cx_set_outputs(&m_config, m_outputs),
+                    "vl53l5cx_set_outputs failed, status %u\n");
+            m_pendingFlags &= ~PENDING_OUTPUTS;
+
+            checkStatus(vl53l5cx_set_nb_target_per_zone(&m_config,
+                        m_targetsPerZone),
+                    "vl53l5cx_set_nb_target_per_zone failed, status %u\n");
+            m_pendingFlags &= ~PENDING_TARGETS;
+
             // Set resolution. As others settings depend to this one, it must come first.
             checkStatus(vl53l5cx_set_resolution(&m_config, m_resolution),
                     "vl53l5cx_set_resolution failed, status %u\n");
@@ -195,6 +214,16 @@ class VL53L5CX {
             Debugger::printf("VL53L5CX is now waking up\n");
              */
 
+            // Capture the applied settings, used as a base for profiles
+            checkStatus(vl53l5cx_get_profile(&m_config, &m_profile),
+                    "vl53l5cx_get_profile failed, status %u\n");
+
+            // No frame yet
+            for (uint8_t k=0; k<2; ++k) {
+                m_results[k].nb_zones = m_resolution;
+                m_results[k].nb_target_per_zone = m_targetsPerZone;
+            }
+
             // Start ranging 
             checkStatus(vl53l5cx_start_ranging(&m_config), "start error = 0x%02X\n"); 
 
@@ -205,6 +234,15 @@ class VL53L5CX {
                     "check data ready: %u\n"); 
         }
 
+        // By default, all sensors share the scratch buffer of the driver,
+        // as they are used one at a time.  Sensors used concurrently, e.g.
+        // on separate buses from separate threads, need their own scratch.
+        // Must be called before begin().
+        void setScratch(VL53L5CX_Scratch & scratch)
+        {
+            vl53l5cx_set_scratch(&m_config, &scratch);
+        }
+
         bool dataIsReady(void)
         {
             uint8_t isReady = 0;
@@ -218,35 +256,422 @@ class VL53L5CX {
             return isReady != 0;
         }
 
+        // The frame is decoded into the back buffer, then published at once,
+        // so that getters called from another thread or an ISR see either
+        // the previous frame or this one, never a mix.  A reader keeping a
+        // reference from getResults() must be done with it before the next
+        // frame is read.  In lazy mode, the frame is published before its
+        // fields are decoded by the getters, which must then be called from
+        // the thread reading the data.
         void readData(void)
         {
             // status = vl53l5cx_get_resolution(&m_config, &resolution);
-            vl53l5cx_get_ranging_data(&m_config, &m_results);
+            const uint8_t back = 1 - m_front;
+
+            if (m_lazy) {
+                vl53l5cx_get_raw_data(&m_config, &m_results[back]);
+                m_decoded = 0;
+            }
+            else {
+                vl53l5cx_get_ranging_data(&m_config, &m_results[back]);
+            }
+
+            __atomic_store_n(&m_front, back, __ATOMIC_RELEASE);
+
+            // Apply any queued settings now that the frame has been consumed
+            if (m_pendingFlags) {
+                applyPendingConfig();
+            }
+        }
+
+        // Alternatives to readData() writing contiguous float or Q16.16
+        // arrays (see VL53L5CX_ResultsFloat); the getters of this class are
+        // not updated
+        void readData(VL53L5CX_ResultsFloat & results)
+        {
+            releaseScratch();
+            vl53l5cx_get_ranging_data_float(&m_config, &results);
+
+            if (m_pendingFlags) {
+                applyPendingConfig();
+            }
+        }
+
+        void readData(VL53L5CX_ResultsFixed & results)
+        {
+            releaseScratch();
+            vl53l5cx_get_ranging_data_fixed(&m_config, &results);
+
+            if (m_pendingFlags) {
+                applyPendingConfig();
+            }
+        }
+
+        // Alternative to readData() decoding into a frame of the pool, which
+        // the caller holds once and must release; other consumers retain it
+        // as needed.  Returns NULL, leaving the frame to be read again, if
+        // every frame of the pool is held, or if it could not be read.  The
+        // getters of this class are not updated.
+        const VL53L5CX_ResultsData * readData(VL53L5CX_FramePool & pool)
+        {
+            VL53L5CX_ResultsData * frame = pool.acquire();
+
+            if (frame == NULL) {
+                return NULL;
+            }
+
+            releaseScratch();
+
+            if (vl53l5cx_get_ranging_data(&m_config, frame) !=
+                    VL53L5CX_STATUS_OK) {
+                pool.release(frame);
+                frame = NULL;
+            }
+
+            if (m_pendingFlags) {
+                applyPendingConfig();
+            }
+
+            return frame;
+        }
+
+        // Alternative to readData() decoding into the next frame of the
+        // ring, for a consumer on another thread or in an ISR.  Returns false
+        // if the ring is full, counting a dropped frame, or if the frame
+        // could not be read.  The getters of this class are not updated.
+        bool readData(VL53L5CX_FrameRing & ring)
+        {
+            releaseScratch();
+
+            VL53L5CX_ResultsData * frame = ring.claim();
+
+            const bool read = frame != NULL &&
+                vl53l5cx_get_ranging_data(&m_config, frame) ==
+                VL53L5CX_STATUS_OK;
+
+            if (read) {
+                ring.commit();
+            }
+
+            if (m_pendingFlags) {
+                applyPendingConfig();
+            }
+
+            return read;
+        }
+
+        // Alternative to readData() decoding into the next frame of the
+        // channel, for subscribers on other threads or in ISRs, overwriting
+        // the oldest frame.  Returns false if the frame could not be read.
+        // The getters of this class are not updated.
+        bool readData(VL53L5CX_FrameChannel & channel)
+        {
+            releaseScratch();
+
+            const bool read = vl53l5cx_get_ranging_data(&m_config,
+                    channel.claim()) == VL53L5CX_STATUS_OK;
+
+            if (read) {
+                channel.commit();
+            }
+
+            if (m_pendingFlags) {
+                applyPendingConfig();
+            }
+
+            return read;
+        }
+
+        // readData(), then publishes the frame for readers on other threads
+        // or in ISRs, which copy it out of the slot without ever holding up
+        // this thread.  The frame is read before it is published, so readers
+        // only retry for the copy, not for the I2C transfer.
+        void readData(VL53L5CX_LatestFrame & latest)
+        {
+            readData();
+            decode(VL53L5CX_OUTPUT_ALL);
+            latest.publish(front());
+        }
+
+        // Compact alternative to readData() for 4x4 sessions (see
+        // VL53L5CX_Results4x4); the results are left unchanged at 8x8
+        void readData(VL53L5CX_Results4x4 & results)
+        {
+            releaseScratch();
+            vl53l5cx_get_ranging_data_4x4(&m_config, &results);
+
+            if (m_pendingFlags) {
+                applyPendingConfig();
+            }
+        }
+
+        // Zero-copy alternative to readData(): the frame is viewed in place
+        // until the next call to the sensor, and the getters of this class
+        // are not updated.  Queued settings are applied first, dropping this
+        // frame, so the view is then empty.
+        const VL53L5CX_FrameView & readFrameView(void)
+        {
+            m_view = VL53L5CX_FrameView();
+
+            if (m_pendingFlags) {
+                applyPendingConfig();
+            }
+            else {
+                releaseScratch();
+                vl53l5cx_get_raw_data(&m_config, NULL);
+                m_view.attach(&m_config);
+            }
+
+            return m_view;
+        }
+
+        // Queued reconfiguration: changes are staged here and applied by the
+        // next readData(), right after the frame has been read, so that the
+        // sensor is only paused for the gap between two frames.
+
+        bool queueFrequency(const uint8_t hz)
+        {
+            const uint8_t maxHz = m_resolution == VL53L5CX_RESOLUTION_4X4 ? 60 : 15;
+
+            if (hz < 1 || hz > maxHz) {
+                return false;
+            }
+
+            m_pendingFrequency = hz;
+            m_pendingFlags |= PENDING_FREQUENCY;
+            return true;
+        }
+
+        bool queueIntegrationTime(const uint16_t ms)
+        {
+            // Integration time is fixed in continuous mode
+            if (m_integralTime == 0 || ms < 2) {
+                return false;
+            }
+
+            m_pendingIntegralTime = ms;
+            m_pendingFlags |= PENDING_INTEGRATION_TIME;
+            return true;
+        }
+
+        bool queueSharpenerPercent(const uint8_t percent)
+        {
+            if (percent > 99) {
+                return false;
+            }
+
+            m_pendingSharpener = percent;
+            m_pendingFlags |= PENDING_SHARPENER;
+            return true;
+        }
+
+        bool queueTargetOrder(const uint8_t order)
+        {
+            if (order != VL53L5CX_TARGET_ORDER_CLOSEST &&
+                    order != VL53L5CX_TARGET_ORDER_STRONGEST) {
+                return false;
+            }
+
+            m_pendingTargetOrder = order;
+            m_pendingFlags |= PENDING_TARGET_ORDER;
+            return true;
+        }
+
+        // In lazy mode, readData() only transfers the frame, and each field
+        // is decoded by the first getter that needs it.  The frame stays in
+        // the scratch buffer only until another sensor sharing it is used;
+        // fields that were not decoded then keep the values of an earlier
+        // frame.
+        void setLazyDecoding(const bool lazy)
+        {
+            decode(VL53L5CX_OUTPUT_ALL);
+            m_lazy = lazy;
+        }
+
+        // Selects the blocks streamed by the sensor (VL53L5CX_OUTPUT_...
+        // flags); fewer blocks mean less I2C time per frame.  Before
+        // begin(), it only sets the outputs of the first session.
+        bool queueOutputs(const uint32_t outputs)
+        {
+            if (outputs & ~VL53L5CX_OUTPUT_ALL) {
+                return false;
+            }
+
+            m_outputs = outputs;
+            m_pendingFlags |= PENDING_OUTPUTS;
+            return true;
+        }
+
+        // Selects the targets reported per zone, 1 to
+        // VL53L5CX_NB_TARGET_PER_ZONE.  Before begin(), it only sets the
+        // targets of the first session.
+        bool queueTargetsPerZone(const uint8_t targets)
+        {
+            if (targets < 1 || targets > VL53L5CX_NB_TARGET_PER_ZONE) {
+                return false;
+            }
+
+            m_targetsPerZone = targets;
+            m_pendingFlags |= PENDING_TARGETS;
+            return true;
+        }
+
+        bool configIsPending(void)
+        {
+            return m_pendingFlags != 0;
+        }
+
+        // Sensing profiles: the DCI blocks of each profile are computed once,
+        // after begin(), and switching only writes the blocks that changed.
+
+        void compileProfile(
+                VL53L5CX_Profile & profile,
+                const uint16_t integralTime,
+                const res4X4_t resFreq,
+                const uint8_t targetOrder=VL53L5CX_TARGET_ORDER_CLOSEST)
+        {
+            compileProfile(profile, integralTime, VL53L5CX_RESOLUTION_4X4,
+                    (uint8_t)resFreq, targetOrder);
+        }
+
+        void compileProfile(
+                VL53L5CX_Profile & profile,
+                const uint16_t integralTime,
+                const res8X8_t resFreq,
+                const uint8_t targetOrder=VL53L5CX_TARGET_ORDER_CLOSEST)
+        {
+            compileProfile(profile, integralTime, VL53L5CX_RESOLUTION_8X8,
+                    (uint8_t)resFreq, targetOrder);
+        }
+
+        void queueProfile(VL53L5CX_Profile & profile)
+        {
+            m_pendingProfile = &profile;
+            m_pendingFlags |= PENDING_PROFILE;
+        }
+
+        // Threshold-interrupt mode: once thresholds are set, the sensor only
+        // raises INT when they are met, so the host can stay idle and call
+        // readData() from its interrupt flag instead of polling dataIsReady().
+
+        static bool compileThresholds(
+                VL53L5CX_DetectionThresholdsSet & set,
+                const VL53L5CX_DetectionThresholds * thresholds)
+        {
+            return vl53l5cx_compile_detection_thresholds(thresholds, &set) ==
+                VL53L5CX_STATUS_OK;
+        }
+
+        void queueThresholds(VL53L5CX_DetectionThresholdsSet & set)
+        {
+            m_pendingThresholds = &set;
+            m_pendingFlags |= PENDING_THRESHOLDS;
+            m_pendingFlags &= ~PENDING_THRESHOLDS_OFF;
+        }
+
+        void queueThresholdsDisable(void)
+        {
+            m_pendingFlags |= PENDING_THRESHOLDS_OFF;
+            m_pendingFlags &= ~PENDING_THRESHOLDS;
+        }
+
+        // Applies immediately instead of waiting for the next frame, which
+        // may never come once thresholds are enabled
+        void setThresholds(VL53L5CX_DetectionThresholdsSet & set)
+        {
+            queueThresholds(set);
+            applyPendingConfig();
+        }
+
+        bool thresholdsEnabled(void)
+        {
+            return m_thresholdsEnabled;
+        }
+
+        // Motion indicator: build the configuration with the
+        // vl53l5cx_motion_indicator_config_*() functions, then send it with a
+        // single DCI write at the next frame boundary.
+
+        void queueMotionConfig(VL53L5CX_Motion_Configuration & config)
+        {
+            m_pendingMotionConfig = &config;
+            m_pendingFlags |= PENDING_MOTION_CONFIG;
+        }
+
+        void setMotionConfig(VL53L5CX_Motion_Configuration & config)
+        {
+            queueMotionConfig(config);
+            applyPendingConfig();
+        }
+
+#ifndef VL53L5CX_DISABLE_MOTION_DETECTOR
+        uint32_t getMotionIndicator(const uint8_t aggregate)
+        {
+            decode(VL53L5CX_OUTPUT_MOTION_INDICATOR);
+            return front().motion_indicator.motion[aggregate];
+        }
+#endif
+
+        // Bit i is set if threshold i is met by the last frame read
+        uint64_t getFiredThresholds(void)
+        {
+            uint64_t fired = 0;
+
+            if (m_thresholdsEnabled) {
+                decode(VL53L5CX_OUTPUT_ALL);
+                vl53l5cx_check_detection_thresholds(&m_thresholds,
+                        &front(), &fired);
+            }
+
+            return fired;
+        }
+
+        // Last frame published by readData(), for reading several fields of
+        // the same frame
+        const VL53L5CX_ResultsData & getResults(void)
+        {
+            decode(VL53L5CX_OUTPUT_ALL);
+            return front();
         }
 
+        // Zones carrying data in the last frame; later pixels are stale
         uint8_t getPixelCount(void)
         {
-            return m_resolution;
+            return front().nb_zones;
         }
 
-        uint8_t getTargetStatus(const uint8_t pixel)
+        // Targets per zone in the last frame
+        uint8_t getTargetsPerZone(void)
         {
-            return m_results.target_status[VL53L5CX_NB_TARGET_PER_ZONE * pixel];
+            return front().nb_target_per_zone;
         }
 
-        int16_t getDistanceMm(const uint8_t pixel)
+        uint8_t getTargetStatus(const uint8_t pixel, const uint8_t target=0)
         {
-            return m_results.distance_mm[VL53L5CX_NB_TARGET_PER_ZONE * pixel];
+            decode(VL53L5CX_OUTPUT_TARGET_STATUS);
+            const VL53L5CX_ResultsData & results = front();
+            return results.target_status[
+                results.nb_target_per_zone * pixel + target];
+        }
+
+        int16_t getDistanceMm(const uint8_t pixel, const uint8_t target=0)
+        {
+            decode(VL53L5CX_OUTPUT_DISTANCE_MM);
+            const VL53L5CX_ResultsData & results = front();
+            return results.distance_mm[
+                results.nb_target_per_zone * pixel + target];
         }
 
         uint8_t getTargetDetectedCount(const uint8_t pixel)
         {
-            return m_results.nb_target_detected[pixel];
+            decode(VL53L5CX_OUTPUT_NB_TARGET_DETECTED);
+            return front().nb_target_detected[pixel];
         }
 
         uint8_t getAmbientPerSpad(const uint8_t pixel)
         {
-            return m_results.ambient_per_spad[pixel];
+            decode(VL53L5CX_OUTPUT_AMBIENT_PER_SPAD);
+            return front().ambient_per_spad[pixel];
         }
 
     protected:
@@ -278,25 +703,267 @@ class VL53L5CX {
                 const uint8_t res,
                 const uint8_t freq,
                 const uint8_t address)
+            : m_config()
         {
+            vl53l5cx_config_init(&m_config);
+            vl53l5cx_set_calibration(&m_config, &m_calibration);
             m_lpnPin = lpnPin;
             m_config.platform.address = address;
             m_config.platform.device = i2c_device;
             m_integralTime = integralTime;
             m_resolution = res;
             m_frequency = freq;
+            m_outputs = VL53L5CX_OUTPUT_ALL;
+            m_targetsPerZone = 1;
+            m_lazy = false;
+            m_decoded = VL53L5CX_OUTPUT_ALL;
+            m_front = 0;
+            m_pendingFlags = 0;
+            m_thresholds.uploaded = 0;
+            m_thresholdsEnabled = false;
         }
 
 
     private:
 
+        static const uint16_t PENDING_FREQUENCY        = 0x0001;
+        static const uint16_t PENDING_INTEGRATION_TIME = 0x0002;
+        static const uint16_t PENDING_SHARPENER        = 0x0004;
+        static const uint16_t PENDING_TARGET_ORDER     = 0x0008;
+        static const uint16_t PENDING_PROFILE          = 0x0010;
+        static const uint16_t PENDING_THRESHOLDS       = 0x0020;
+        static const uint16_t PENDING_THRESHOLDS_OFF   = 0x0040;
+        static const uint16_t PENDING_MOTION_CONFIG    = 0x0080;
+        static const uint16_t PENDING_OUTPUTS          = 0x0100;
+        static const uint16_t PENDING_TARGETS          = 0x0200;
+
         VL53L5CX_Configuration m_config;
-        VL53L5CX_ResultsData m_results;
+
+        // Offsets, only used when starting and when changing resolution;
+        // the sensor keeps the default xtalk of the driver
+        VL53L5CX_Calibration m_calibration;
+
+        // Ping-pong results: readData() decodes, or in lazy mode reads, into
+        // m_results[1 - m_front] and then publishes it by flipping m_front;
+        // lazy decoding then fills in m_results[m_front]
+        VL53L5CX_ResultsData m_results[2];
+        uint8_t m_front;
 
         uint8_t m_lpnPin;
         uint8_t m_resolution;
         uint8_t m_frequency;
-        uint8_t m_integralTime;
+        uint16_t m_integralTime;  // ms, 0 in continuous mode
+        uint32_t m_outputs;
+        uint8_t m_targetsPerZone;
+
+        // Lazy decoding: fields of the last frame already decoded
+        bool m_lazy;
+        uint32_t m_decoded;
+
+        VL53L5CX_FrameView m_view;
+
+        uint16_t m_pendingFlags;
+        uint8_t m_pendingFrequency;
+        uint16_t m_pendingIntegralTime;
+        uint8_t m_pendingSharpener;
+        uint8_t m_pendingTargetOrder;
+        VL53L5CX_Profile * m_pendingProfile;
+
+        // Settings currently applied to the sensor
+        VL53L5CX_Profile m_profile;
+
+        // Thresholds currently on the sensor, for differential uploads
+        VL53L5CX_DetectionThresholdsSet m_thresholds;
+        VL53L5CX_DetectionThresholdsSet * m_pendingThresholds;
+        bool m_thresholdsEnabled;
+
+        VL53L5CX_Motion_Configuration * m_pendingMotionConfig;
+
+        void compileProfile(
+                VL53L5CX_Profile & profile,
+                const uint16_t integralTime,
+                const uint8_t res,
+                const uint8_t freq,
+                const uint8_t targetOrder)
+        {
+            memcpy(&profile, &m_profile, sizeof(VL53L5CX_Profile));
+
+            checkStatus(vl53l5cx_profile_set_resolution(&profile, res),
+                    "vl53l5cx_profile_set_resolution failed, status %u\n");
+
+            checkStatus(vl53l5cx_profile_set_ranging_frequency_hz(&profile, freq),
+                    "vl53l5cx_profile_set_ranging_frequency_hz failed, status %u\n");
+
+            if (integralTime > 0) {
+
+                checkStatus(vl53l5cx_profile_set_ranging_mode(&profile,
+                            VL53L5CX_RANGING_MODE_AUTONOMOUS),
+                        "vl53l5cx_profile_set_ranging_mode failed, status %u\n");
+
+                checkStatus(vl53l5cx_profile_set_integration_time_ms(&profile,
+                            integralTime),
+                        "vl53l5cx_profile_set_integration_time_ms failed, status %u\n");
+            }
+            else {
+                checkStatus(vl53l5cx_profile_set_ranging_mode(&profile,
+                            VL53L5CX_RANGING_MODE_CONTINUOUS),
+                        "vl53l5cx_profile_set_ranging_mode failed, status %u\n");
+            }
+
+            checkStatus(vl53l5cx_profile_set_target_order(&profile, targetOrder),
+                    "vl53l5cx_profile_set_target_order failed, status %u\n");
+        }
+
+        const VL53L5CX_ResultsData & front(void) const
+        {
+            return m_results[__atomic_load_n(&m_front, __ATOMIC_ACQUIRE)];
+        }
+
+        void decode(const uint32_t outputs)
+        {
+            if ((m_decoded & outputs) == outputs) {
+                return;
+            }
+
+            for (uint32_t output=VL53L5CX_OUTPUT_AMBIENT_PER_SPAD;
+                    output<=VL53L5CX_OUTPUT_MOTION_INDICATOR; output<<=1) {
+                if ((outputs & output) && !(m_decoded & output)) {
+                    // Fails harmlessly for fields that are not streamed
+                    vl53l5cx_decode_field(&m_config, &m_results[m_front],
+                            output);
+                }
+            }
+
+            m_decoded |= outputs;
+        }
+
+        // The alternatives to readData() reuse the scratch, which in lazy
+        // mode still holds the raw frame of the results: their fields not
+        // decoded yet must be decoded first
+        void releaseScratch(void)
+        {
+            decode(VL53L5CX_OUTPUT_ALL);
+        }
+
+        void applyPendingConfig(void)
+        {
+            // Reconfiguring reuses the receive buffer, so the frame must be
+            // fully decoded first
+            decode(VL53L5CX_OUTPUT_ALL);
+
+            // Unless resolution, outputs or targets change, the output list
+            // programmed by vl53l5cx_start_ranging() is still valid and we
+            // can resume without re-sending it.
+            checkStatus(vl53l5cx_stop_ranging(&m_config),
+                    "vl53l5cx_stop_ranging failed, status %u\n");
+
+            const uint8_t resolution = m_resolution;
+
+            // Profile first, so that single settings queued after it win
+            if (m_pendingFlags & PENDING_PROFILE) {
+                checkStatus(vl53l5cx_apply_profile(&m_config, &m_profile,
+                            m_pendingProfile),
+                        "vl53l5cx_apply_profile failed, status %u\n");
+                m_resolution = m_profile.resolution;
+                m_frequency = m_profile.freq_hz[0x01];
+                if (m_profile.ranging_mode[0x01] == 0x1) {
+                    m_integralTime = 0;
+                }
+                else {
+                    uint32_t integration = 0;
+                    memcpy(&integration, m_profile.int_time, 4);
+                    m_integralTime = (uint16_t)(integration / 1000);
+                }
+            }
+
+            // Single settings also update the profile image, so that the
+            // next profile switch diffs against what is really applied
+            if (m_pendingFlags & PENDING_FREQUENCY) {
+                checkStatus(vl53l5cx_set_ranging_frequency_hz(&m_config,
+                            m_pendingFrequency),
+                        "vl53l5cx_set_ranging_frequency_hz failed, status %u\n");
+                vl53l5cx_profile_set_ranging_frequency_hz(&m_profile,
+                        m_pendingFrequency);
+                m_frequency = m_pendingFrequency;
+            }
+
+            if (m_pendingFlags & PENDING_INTEGRATION_TIME) {
+                checkStatus(vl53l5cx_set_integration_time_ms(&m_config,
+                            m_pendingIntegralTime),
+                        "vl53l5cx_set_integration_time_ms failed, status %u\n");
+                vl53l5cx_profile_set_integration_time_ms(&m_profile,
+                        m_pendingIntegralTime);
+                m_integralTime = m_pendingIntegralTime;
+            }
+
+            if (m_pendingFlags & PENDING_SHARPENER) {
+                checkStatus(vl53l5cx_set_sharpener_percent(&m_config,
+                            m_pendingSharpener),
+                        "vl53l5cx_set_sharpener_percent failed, status %u\n");
+                vl53l5cx_profile_set_sharpener_percent(&m_profile,
+                        m_pendingSharpener);
+            }
+
+            if (m_pendingFlags & PENDING_TARGET_ORDER) {
+                checkStatus(vl53l5cx_set_target_order(&m_config,
+                            m_pendingTargetOrder),
+                        "vl53l5cx_set_target_order failed, status %u\n");
+                vl53l5cx_profile_set_target_order(&m_profile,
+                        m_pendingTargetOrder);
+            }
+
+            if (m_pendingFlags & PENDING_THRESHOLDS) {
+                checkStatus(vl53l5cx_upload_detection_thresholds(&m_config,
+                            &m_thresholds, m_pendingThresholds),
+                        "vl53l5cx_upload_detection_thresholds failed, status %u\n");
+                if (!m_thresholdsEnabled) {
+                    checkStatus(vl53l5cx_set_detection_thresholds_enable(
+                                &m_config, 1),
+                            "vl53l5cx_set_detection_thresholds_enable failed, "
+                            "status %u\n");
+                    m_thresholdsEnabled = true;
+                }
+            }
+
+            if ((m_pendingFlags & PENDING_THRESHOLDS_OFF) && m_thresholdsEnabled) {
+                checkStatus(vl53l5cx_set_detection_thresholds_enable(&m_config, 0),
+                        "vl53l5cx_set_detection_thresholds_enable failed, "
+                        "status %u\n");
+                m_thresholdsEnabled = false;
+            }
+
+            if (m_pendingFlags & PENDING_MOTION_CONFIG) {
+                checkStatus(vl53l5cx_motion_indicator_set_config(&m_config,
+                            m_pendingMotionConfig),
+                        "vl53l5cx_motion_indicator_set_config failed, status %u\n");
+            }
+
+            const bool outputs = m_pendingFlags & PENDING_OUTPUTS;
+            if (outputs) {
+                checkStatus(vl53l5cx_set_outputs(&m_config, m_outputs),
+                        "vl53l5cx_set_outputs failed, status %u\n");
+            }
+
+            const bool targets = m_pendingFlags & PENDING_TARGETS;
+            if (targets) {
+                checkStatus(vl53l5cx_set_nb_target_per_zone(&m_config,
+                            m_targetsPerZone),
+                        "vl53l5cx_set_nb_target_per_zone failed, status %u\n");
+            }
+
+            m_pendingFlags = 0;
+
+            // A new resolution, output selection or target count changes the
+            // output blocks, so the output list has to be programmed again
+            if (m_resolution != resolution || outputs || targets) {
+                checkStatus(vl53l5cx_start_ranging(&m_config),
+                        "vl53l5cx_start_ranging failed, status %u\n");
+            }
+            else {
+                checkStatus(vl53l5cx_resume_ranging(&m_config),
+                        "vl53l5cx_resume_ranging failed, status %u\n");
+            }
+        }
 
         void enable(void)
         {
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "vl53l5cx.hpp"
+#include "vl53l5cx_static.hpp"
 
 class VL53L5CX_Arduino : public VL53L5CX {
 
@@ -35,3 +36,25 @@ class VL53L5CX_Arduino : public VL53L5CX {
         }
 
 }; // class VL53L5CX_Arduino
+
+template <
+    uint8_t RESOLUTION,
+    uint8_t TARGETS=1,
+    uint32_t OUTPUTS=VL53L5CX_OUTPUT_ALL>
+class VL53L5CX_StaticArduino :
+    public VL53L5CX_Static<RESOLUTION, TARGETS, OUTPUTS> {
+
+    public:
+
+        VL53L5CX_StaticArduino(
+                const uint8_t lpnPin,
+                const uint8_t integralTime,
+                const uint8_t freq,
+                TwoWire * twoWire=&Wire,
+                const uint8_t address=0x29)
+            : VL53L5CX_Static<RESOLUTION, TARGETS, OUTPUTS>(
+                    (void *)twoWire, lpnPin, integralTime, freq, address)
+        {
+        }
+
+}; // class VL53L5CX_StaticArduino
@@ -0,0 +1,89 @@
+/*
+   Memory and bus budget of a VL53L5CX configuration, known at compile time
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#pragma once
+
+#include "vl53l5cx_static_results.hpp"
+
+#include "st/vl53l5cx_api.h"
+
+#include <stdint.h>
+
+// RAM, flash and bytes per frame for a resolution, a number of targets per
+// zone and a set of outputs; every value can be checked with static_assert
+// against a budget:
+//
+//   typedef VL53L5CX_Budget<VL53L5CX_RESOLUTION_4X4> Budget;
+//   static_assert(Budget::ram(2, true) <= 8192, "two sensors use too much");
+template <
+    uint8_t RESOLUTION,
+    uint8_t TARGETS=1,
+    uint32_t OUTPUTS=VL53L5CX_OUTPUT_ALL>
+class VL53L5CX_Budget {
+
+    public:
+
+        typedef VL53L5CX_StaticLayout<RESOLUTION, TARGETS, OUTPUTS> Layout;
+
+        // Driver state, one per sensor
+        static constexpr uint32_t CONFIG_RAM = sizeof(VL53L5CX_Configuration);
+
+        // Offsets, one per sensor, only used when starting and when
+        // changing resolution
+        static constexpr uint32_t CALIBRATION_RAM =
+            sizeof(VL53L5CX_Calibration);
+
+        // Xtalk storage, only for the sensors calibrating xtalk; the others
+        // share the default xtalk stored in flash
+        static constexpr uint32_t XTALK_RAM = VL53L5CX_XTALK_BUFFER_SIZE;
+
+        // Temporary buffer, shared by every sensor unless given their own;
+        // sized by the macros of vl53l5cx_api.h, not by this configuration
+        static constexpr uint32_t SCRATCH_RAM = sizeof(VL53L5CX_Scratch);
+
+        // Ping-pong results of VL53L5CX, sized for any configuration
+        static constexpr uint32_t RESULTS_RAM =
+            2 * sizeof(VL53L5CX_ResultsData);
+
+        // Results of VL53L5CX_Static, sized for this configuration
+        static constexpr uint32_t STATIC_RESULTS_RAM =
+            sizeof(VL53L5CX_StaticResults<RESOLUTION, TARGETS, OUTPUTS>);
+
+        // Firmware, default configuration and default xtalk, stored once
+        static constexpr uint32_t FLASH = VL53L5CX_FIRMWARE_SIZE +
+            VL53L5CX_CONFIGURATION_SIZE + VL53L5CX_XTALK_BUFFER_SIZE;
+
+        // Bytes read over I2C per frame
+        static constexpr uint32_t FRAME_BYTES = Layout::DATA_READ_SIZE;
+
+        // RAM of one sensor, without the scratch
+        static constexpr uint32_t sensorRam(const bool staticResults)
+        {
+            return CONFIG_RAM + CALIBRATION_RAM +
+                (staticResults ? STATIC_RESULTS_RAM : RESULTS_RAM);
+        }
+
+        // RAM of several sensors sharing one scratch, or each with its own,
+        // xtalkSensors of them calibrating xtalk
+        static constexpr uint32_t ram(
+                const uint8_t sensors,
+                const bool staticResults,
+                const bool sharedScratch=true,
+                const uint8_t xtalkSensors=0)
+        {
+            return sensors * sensorRam(staticResults) +
+                (sharedScratch ? 1 : sensors) * SCRATCH_RAM +
+                xtalkSensors * XTALK_RAM;
+        }
+
+        static constexpr uint32_t busBytesPerSecond(const uint8_t frequencyHz)
+        {
+            return FRAME_BYTES * frequencyHz;
+        }
+
+}; // class VL53L5CX_Budget
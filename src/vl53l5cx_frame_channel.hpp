@@ -0,0 +1,244 @@
+/*
+   Broadcast channel of VL53L5CX frames, from one producer to any number of
+   subscribers
+
+   The producer decodes each frame once, straight into the channel, and never
+   waits: it does not know the subscribers.  Each subscriber follows the
+   frames with its own cursor, takes one frame out of every few, and decides
+   what to do when it falls so far behind that the producer has overwritten
+   the frames it had not read yet.
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#pragma once
+
+#include "st/vl53l5cx_api.h"
+
+#include <stdint.h>
+#include <string.h>
+
+// claim() and commit() must only be called from the producer; subscribers
+// can read from any thread, each subscriber from one thread at a time
+class VL53L5CX_FrameChannel {
+
+    friend class VL53L5CX_FrameSubscriber;
+
+    public:
+
+        // Producer: returns the slot of the next frame, overwriting the
+        // oldest frame of the channel
+        VL53L5CX_ResultsData * claim(void)
+        {
+            const uint8_t slot = (m_published + 1) & m_mask;
+
+            // Subscribers still copying the oldest frame will see it is gone
+            __atomic_store_n(&m_numbers[slot], 0, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+
+            return &m_frames[slot];
+        }
+
+        // Producer: publishes the claimed frame
+        void commit(void)
+        {
+            const uint32_t number = m_published + 1;
+
+            __atomic_store_n(&m_numbers[number & m_mask], number,
+                    __ATOMIC_RELEASE);
+            __atomic_store_n(&m_published, number, __ATOMIC_RELEASE);
+        }
+
+        // Number of the last frame published, frames being numbered from 1
+        uint32_t published(void) const
+        {
+            return __atomic_load_n(&m_published, __ATOMIC_ACQUIRE);
+        }
+
+        uint8_t capacity(void) const
+        {
+            return m_mask + 1;
+        }
+
+    protected:
+
+        VL53L5CX_FrameChannel(
+                VL53L5CX_ResultsData * frames,
+                uint32_t * numbers,
+                const uint8_t capacity)
+            : m_frames(frames), m_numbers(numbers), m_mask(capacity - 1),
+            m_published(0)
+        {
+            for (uint8_t i=0; i<capacity; ++i) {
+                m_numbers[i] = 0;
+            }
+        }
+
+    private:
+
+        VL53L5CX_ResultsData * m_frames;
+
+        // Number of the frame in each slot, 0 while it is being written
+        uint32_t * m_numbers;
+
+        uint8_t m_mask;
+
+        uint32_t m_published;
+
+}; // class VL53L5CX_FrameChannel
+
+// Channel storage, statically allocated with the channel
+template <uint8_t CAPACITY>
+class VL53L5CX_StaticFrameChannel : public VL53L5CX_FrameChannel {
+
+    static_assert(CAPACITY >= 2 && CAPACITY <= 128 &&
+            (CAPACITY & (CAPACITY - 1)) == 0,
+            "VL53L5CX frame channel capacity must be a power of two from 2 "
+            "to 128");
+
+    public:
+
+        VL53L5CX_StaticFrameChannel(void)
+            : VL53L5CX_FrameChannel(m_storage, m_frameNumbers, CAPACITY)
+        {
+        }
+
+    private:
+
+        VL53L5CX_ResultsData m_storage[CAPACITY];
+        uint32_t m_frameNumbers[CAPACITY];
+
+}; // class VL53L5CX_StaticFrameChannel
+
+class VL53L5CX_FrameSubscriber {
+
+    public:
+
+        // What to do with the frames the producer has overwritten before
+        // they could be read
+        typedef enum {
+
+            // Resume with the oldest frame still in the channel, losing as
+            // few frames as possible (recording)
+            SKIP_TO_OLDEST,
+
+            // Resume with the last frame published, dropping the backlog
+            // (control, telemetry)
+            SKIP_TO_LATEST
+
+        } overflow_t;
+
+        // Starts with the next frame published, then takes one frame out of
+        // every decimation
+        VL53L5CX_FrameSubscriber(
+                const VL53L5CX_FrameChannel & channel,
+                const uint8_t decimation=1,
+                const overflow_t overflow=SKIP_TO_OLDEST)
+            : m_channel(channel),
+            m_cursor(channel.published() + 1),
+            m_decimation(decimation > 0 ? decimation : 1),
+            m_overflow(overflow),
+            m_missed(0)
+        {
+        }
+
+        // Copies the next frame due to this subscriber; returns false if it
+        // has not been published yet.  The number of the frame is returned
+        // in number if given.
+        bool read(VL53L5CX_ResultsData & frame, uint32_t * number=NULL)
+        {
+            while (true) {
+
+                const uint32_t published = m_channel.published();
+
+                if ((int32_t)(published - m_cursor) < 0) {
+                    return false;
+                }
+
+                if (copy(frame)) {
+                    if (number) {
+                        *number = m_cursor;
+                    }
+                    m_cursor += m_decimation;
+                    return true;
+                }
+
+                skip(published);
+            }
+        }
+
+        bool setDecimation(const uint8_t decimation)
+        {
+            if (decimation == 0) {
+                return false;
+            }
+
+            m_decimation = decimation;
+            return true;
+        }
+
+        // Frames due to this subscriber that were overwritten before it
+        // could read them
+        uint32_t missed(void) const
+        {
+            return m_missed;
+        }
+
+    private:
+
+        const VL53L5CX_FrameChannel & m_channel;
+
+        uint32_t m_cursor;  // number of the next frame to read
+        uint8_t m_decimation;
+        overflow_t m_overflow;
+        uint32_t m_missed;
+
+        // Fails if the frame at the cursor was overwritten, before or while
+        // being copied
+        bool copy(VL53L5CX_ResultsData & frame) const
+        {
+            const uint32_t * number =
+                &m_channel.m_numbers[m_cursor & m_channel.m_mask];
+
+            if (__atomic_load_n(number, __ATOMIC_ACQUIRE) != m_cursor) {
+                return false;
+            }
+
+            memcpy(&frame, &m_channel.m_frames[m_cursor & m_channel.m_mask],
+                    sizeof(frame));
+
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+            return __atomic_load_n(number, __ATOMIC_RELAXED) == m_cursor;
+        }
+
+        void skip(const uint32_t published)
+        {
+            // The slot after the last frame published may already be
+            // claimed for the next one
+            const uint32_t oldest = published - m_channel.m_mask + 1;
+
+            uint32_t cursor = m_overflow == SKIP_TO_LATEST ? published : oldest;
+
+            // Not lapped: only this frame was lost, to a failed read
+            if ((int32_t)(cursor - m_cursor) <= 0) {
+                cursor = m_cursor + m_decimation;
+            }
+
+            // Stay on the decimation grid when catching up with the oldest
+            // frames
+            else if (m_overflow == SKIP_TO_OLDEST) {
+                cursor += (m_decimation - (cursor - m_cursor) % m_decimation) %
+                    m_decimation;
+                if ((int32_t)(published - cursor) < 0) {
+                    cursor = published;
+                }
+            }
+
+            m_missed += (cursor - m_cursor + m_decimation - 1) / m_decimation;
+            m_cursor = cursor;
+        }
+
+}; // class VL53L5CX_FrameSubscriber
@@ -0,0 +1,151 @@
+/*
+   Fixed-capacity pool of VL53L5CX frames with reference counts
+
+   Frames are decoded straight into the pool and shared by pointer, so
+   several consumers can keep the same frame without copying it
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#pragma once
+
+#include "st/vl53l5cx_api.h"
+
+#include <stdint.h>
+
+// Reference counts are not atomic: acquire, retain and release must be called
+// from the same thread, or with interrupts disabled
+class VL53L5CX_FramePool {
+
+    public:
+
+        // Returns a free frame held once by the caller, or NULL if every
+        // frame is still held
+        VL53L5CX_ResultsData * acquire(void)
+        {
+            for (uint8_t i=0; i<m_capacity; ++i) {
+
+                // Start after the last frame handed out, so that the frame
+                // released last is reused last
+                const uint8_t k = (m_next + i) % m_capacity;
+
+                if (m_refs[k] == 0) {
+                    m_refs[k] = 1;
+                    m_next = (k + 1) % m_capacity;
+                    return &m_frames[k];
+                }
+            }
+
+            return NULL;
+        }
+
+        // Holds a frame once more, for another consumer; returns false if the
+        // frame is not held or not from this pool
+        bool retain(const VL53L5CX_ResultsData * frame)
+        {
+            const uint8_t k = index(frame);
+
+            if (k == m_capacity || m_refs[k] == 0 || m_refs[k] == 0xFF) {
+                return false;
+            }
+
+            m_refs[k]++;
+
+            return true;
+        }
+
+        // Drops one hold on a frame, which is reused once every consumer has
+        // released it; returns false if the frame is not held or not from
+        // this pool
+        bool release(const VL53L5CX_ResultsData * frame)
+        {
+            const uint8_t k = index(frame);
+
+            if (k == m_capacity || m_refs[k] == 0) {
+                return false;
+            }
+
+            m_refs[k]--;
+
+            return true;
+        }
+
+        uint8_t references(const VL53L5CX_ResultsData * frame) const
+        {
+            const uint8_t k = index(frame);
+
+            return k == m_capacity ? 0 : m_refs[k];
+        }
+
+        uint8_t capacity(void) const
+        {
+            return m_capacity;
+        }
+
+        // Frames that can be acquired
+        uint8_t available(void) const
+        {
+            uint8_t count = 0;
+
+            for (uint8_t i=0; i<m_capacity; ++i) {
+                count += m_refs[i] == 0;
+            }
+
+            return count;
+        }
+
+    protected:
+
+        VL53L5CX_FramePool(
+                VL53L5CX_ResultsData * frames,
+                uint8_t * refs,
+                const uint8_t capacity)
+            : m_frames(frames), m_refs(refs), m_capacity(capacity), m_next(0)
+        {
+            for (uint8_t i=0; i<m_capacity; ++i) {
+                m_refs[i] = 0;
+            }
+        }
+
+    private:
+
+        VL53L5CX_ResultsData * m_frames;
+        uint8_t * m_refs;
+        uint8_t m_capacity;
+        uint8_t m_next;
+
+        // m_capacity if the frame is not from this pool
+        uint8_t index(const VL53L5CX_ResultsData * frame) const
+        {
+            for (uint8_t i=0; i<m_capacity; ++i) {
+                if (frame == &m_frames[i]) {
+                    return i;
+                }
+            }
+
+            return m_capacity;
+        }
+
+}; // class VL53L5CX_FramePool
+
+// Pool storage, statically allocated with the pool
+template <uint8_t CAPACITY>
+class VL53L5CX_StaticFramePool : public VL53L5CX_FramePool {
+
+    static_assert(CAPACITY > 0, "VL53L5CX frame pool cannot be empty");
+
+    public:
+
+        VL53L5CX_StaticFramePool(void)
+            : VL53L5CX_FramePool(m_storage, m_counts, CAPACITY)
+        {
+        }
+
+    private:
+
+        VL53L5CX_ResultsData m_storage[CAPACITY];
+        uint8_t m_counts[CAPACITY];
+
+}; // class VL53L5CX_StaticFramePool
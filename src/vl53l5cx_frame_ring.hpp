@@ -0,0 +1,189 @@
+/*
+   Lock-free ring of VL53L5CX frames, from one producer to one consumer
+
+   The producer decodes frames straight into the ring; the consumer takes
+   every frame accumulated since its last call at once
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#pragma once
+
+#include "st/vl53l5cx_api.h"
+
+#include <stdint.h>
+
+// Keeps the indices written by the producer and by the consumer apart, so
+// that they do not share a cache line on multicore targets
+#ifndef VL53L5CX_CACHE_LINE_SIZE
+#define VL53L5CX_CACHE_LINE_SIZE 64
+#endif
+
+// Frames dequeued together, oldest first; valid until the next dequeue() or
+// release() of their ring
+class VL53L5CX_FrameBatch {
+
+    friend class VL53L5CX_FrameRing;
+
+    public:
+
+        VL53L5CX_FrameBatch(void)
+            : m_frames(NULL), m_mask(0), m_first(0), m_size(0)
+        {
+        }
+
+        uint8_t size(void) const
+        {
+            return m_size;
+        }
+
+        const VL53L5CX_ResultsData & operator[](const uint8_t k) const
+        {
+            return m_frames[(uint8_t)(m_first + k) & m_mask];
+        }
+
+    private:
+
+        const VL53L5CX_ResultsData * m_frames;
+        uint8_t m_mask;
+        uint8_t m_first;
+        uint8_t m_size;
+
+}; // class VL53L5CX_FrameBatch
+
+// claim() and commit() must only be called from the producer, dequeue() and
+// release() only from the consumer; each side may be a thread or an ISR
+class VL53L5CX_FrameRing {
+
+    public:
+
+        // Producer: returns the next free frame, or NULL, counting a dropped
+        // frame, if the consumer has not released enough frames yet
+        VL53L5CX_ResultsData * claim(void)
+        {
+            const uint8_t head = m_producer.head;
+
+            if ((uint8_t)(head - m_producer.tail) > m_mask) {
+
+                // Only reload the consumer's index when the ring looks full
+                m_producer.tail = __atomic_load_n(&m_consumer.tail,
+                        __ATOMIC_ACQUIRE);
+
+                if ((uint8_t)(head - m_producer.tail) > m_mask) {
+                    __atomic_store_n(&m_producer.dropped,
+                            m_producer.dropped + 1, __ATOMIC_RELAXED);
+                    return NULL;
+                }
+            }
+
+            return &m_frames[head & m_mask];
+        }
+
+        // Producer: hands the claimed frame to the consumer
+        void commit(void)
+        {
+            __atomic_store_n(&m_producer.head, (uint8_t)(m_producer.head + 1),
+                    __ATOMIC_RELEASE);
+        }
+
+        // Consumer: releases the previous batch to the producer and returns
+        // every frame committed since
+        VL53L5CX_FrameBatch dequeue(void)
+        {
+            release();
+
+            VL53L5CX_FrameBatch batch;
+
+            batch.m_frames = m_frames;
+            batch.m_mask = m_mask;
+            batch.m_first = m_consumer.tail;
+            batch.m_size = (uint8_t)(__atomic_load_n(&m_producer.head,
+                        __ATOMIC_ACQUIRE) - m_consumer.tail);
+
+            m_consumer.batch = batch.m_size;
+
+            return batch;
+        }
+
+        // Consumer: releases the previous batch without taking another
+        void release(void)
+        {
+            __atomic_store_n(&m_consumer.tail,
+                    (uint8_t)(m_consumer.tail + m_consumer.batch),
+                    __ATOMIC_RELEASE);
+
+            m_consumer.batch = 0;
+        }
+
+        uint8_t capacity(void) const
+        {
+            return m_mask + 1;
+        }
+
+        // Frames the producer could not claim so far
+        uint32_t dropped(void) const
+        {
+            return __atomic_load_n(&m_producer.dropped, __ATOMIC_RELAXED);
+        }
+
+    protected:
+
+        VL53L5CX_FrameRing(
+                VL53L5CX_ResultsData * frames,
+                const uint8_t capacity)
+            : m_frames(frames), m_mask(capacity - 1)
+        {
+            m_producer.head = 0;
+            m_producer.tail = 0;
+            m_producer.dropped = 0;
+            m_consumer.tail = 0;
+            m_consumer.batch = 0;
+        }
+
+    private:
+
+        // Read-only, kept off the lines of the indices
+        VL53L5CX_ResultsData * m_frames;
+        uint8_t m_mask;
+
+        // Indices count frames modulo 256 and wrap around the ring through
+        // m_mask
+        struct alignas(VL53L5CX_CACHE_LINE_SIZE) Producer {
+            uint8_t head;
+            uint8_t tail;   // last tail seen by the producer
+            uint32_t dropped;
+        };
+
+        struct alignas(VL53L5CX_CACHE_LINE_SIZE) Consumer {
+            uint8_t tail;
+            uint8_t batch;  // size of the batch not yet released
+        };
+
+        Producer m_producer;
+        Consumer m_consumer;
+
+}; // class VL53L5CX_FrameRing
+
+// Ring storage, statically allocated with the ring
+template <uint8_t CAPACITY>
+class VL53L5CX_StaticFrameRing : public VL53L5CX_FrameRing {
+
+    static_assert(CAPACITY >= 2 && CAPACITY <= 128 &&
+            (CAPACITY & (CAPACITY - 1)) == 0,
+            "VL53L5CX frame ring capacity must be a power of two from 2 "
+            "to 128");
+
+    public:
+
+        VL53L5CX_StaticFrameRing(void)
+            : VL53L5CX_FrameRing(m_storage, CAPACITY)
+        {
+        }
+
+    private:
+
+        VL53L5CX_ResultsData m_storage[CAPACITY];
+
+}; // class VL53L5CX_StaticFrameRing
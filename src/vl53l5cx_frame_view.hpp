@@ -0,0 +1,293 @@
+/*
+   Zero-copy view of a VL53L5CX frame
+
+   Exposes the output blocks of a raw frame, in the receive buffer of the
+   driver or in a caller buffer, without decoding them into
+   VL53L5CX_ResultsData
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#pragma once
+
+#include "st/vl53l5cx_api.h"
+
+#include <stdint.h>
+#include <string.h>
+
+// Bounds-checked array of raw block values; reading past the end gives 0
+template <typename T>
+class VL53L5CX_Span {
+
+    public:
+
+        VL53L5CX_Span(void)
+            : m_data(NULL), m_size(0)
+        {
+        }
+
+        VL53L5CX_Span(const uint8_t * data, const uint16_t size)
+            : m_data(data), m_size(size)
+        {
+        }
+
+        uint16_t size(void) const
+        {
+            return m_size;
+        }
+
+        bool empty(void) const
+        {
+            return m_size == 0;
+        }
+
+        T operator[](const uint16_t index) const
+        {
+            T value = 0;
+
+            // Payloads are not always aligned for T
+            if (index < m_size) {
+                memcpy(&value, &m_data[index * sizeof(T)], sizeof(T));
+            }
+
+            return value;
+        }
+
+    private:
+
+        const uint8_t * m_data;
+        uint16_t m_size;
+
+}; // class VL53L5CX_Span
+
+class VL53L5CX_FrameView {
+
+    public:
+
+        VL53L5CX_FrameView(void)
+        {
+            clear();
+        }
+
+        // Views the frame read by vl53l5cx_get_raw_data(), which is swapped
+        // in place.  The view is valid until the next driver call using the
+        // scratch buffer, for this device or any other sharing it.
+        bool attach(VL53L5CX_Configuration * p_dev)
+        {
+            if (p_dev->p_scratch->p_frame_owner != p_dev) {
+                clear();
+                return false;
+            }
+
+            // Once swapped, the frame can no longer be decoded lazily
+            p_dev->p_scratch->p_frame_owner = NULL;
+
+            return attach(p_dev, p_dev->temp_buffer, p_dev->data_read_size);
+        }
+
+        // Views a frame of p_dev->data_read_size bytes read into a caller
+        // buffer, in firmware byte order; the buffer is swapped in place
+        bool attach(
+                const VL53L5CX_Configuration * p_dev,
+                uint8_t * frame,
+                const uint32_t size)
+        {
+            clear();
+
+            if (size < p_dev->data_read_size) {
+                return false;
+            }
+
+            vl53l5cx_swap_buffer(frame, (uint16_t)p_dev->data_read_size);
+
+            for (uint8_t i=0; i<p_dev->decode_plan_size; ++i) {
+
+                const VL53L5CX_DecodeStep * step = &p_dev->decode_plan[i];
+
+                union Block_header bh;
+                memcpy(&bh.bytes, &frame[step->src_offset - 4], 4);
+                if (bh.idx != step->idx) {
+                    clear();
+                    return false;
+                }
+
+                if (!setBlock(step->idx, &frame[step->src_offset], step->size)) {
+                    clear();
+                    return false;
+                }
+            }
+
+            m_zones = p_dev->resolution;
+            m_targetsPerZone = p_dev->nb_target_per_zone;
+
+            return true;
+        }
+
+        // Zones carrying data, 0 if nothing is viewed
+        uint8_t zones(void) const
+        {
+            return m_zones;
+        }
+
+        // Targets per zone in the per-target blocks
+        uint8_t targetsPerZone(void) const
+        {
+            return m_targetsPerZone;
+        }
+
+        // Raw blocks, in firmware units ---------------------------------------
+
+        VL53L5CX_Span<uint32_t> ambientPerSpad(void) const
+        {
+            return m_ambient;
+        }
+
+        VL53L5CX_Span<uint32_t> nbSpadsEnabled(void) const
+        {
+            return m_spads;
+        }
+
+        VL53L5CX_Span<uint8_t> nbTargetDetected(void) const
+        {
+            return m_targets;
+        }
+
+        VL53L5CX_Span<uint32_t> signalPerSpad(void) const
+        {
+            return m_signal;
+        }
+
+        VL53L5CX_Span<uint16_t> rangeSigma(void) const
+        {
+            return m_sigma;
+        }
+
+        VL53L5CX_Span<int16_t> distance(void) const
+        {
+            return m_distance;
+        }
+
+        VL53L5CX_Span<uint8_t> reflectance(void) const
+        {
+            return m_reflectance;
+        }
+
+        VL53L5CX_Span<uint8_t> targetStatus(void) const
+        {
+            return m_status;
+        }
+
+        // Values converted as vl53l5cx_get_ranging_data() does ---------------
+
+        uint8_t getTargetDetectedCount(const uint8_t zone) const
+        {
+            return m_targets[zone];
+        }
+
+        uint32_t getAmbientPerSpad(const uint8_t zone) const
+        {
+            return m_ambient[zone] / 2048;
+        }
+
+        uint32_t getSignalPerSpad(const uint8_t zone, const uint8_t target=0) const
+        {
+            return m_signal[index(zone, target)] / 2048;
+        }
+
+        uint16_t getRangeSigmaMm(const uint8_t zone, const uint8_t target=0) const
+        {
+            return m_sigma[index(zone, target)] / 128;
+        }
+
+        int16_t getDistanceMm(const uint8_t zone, const uint8_t target=0) const
+        {
+            const int16_t distance = m_distance[index(zone, target)];
+
+            return distance < 0 ? 0 : distance / 4;
+        }
+
+        uint8_t getTargetStatus(const uint8_t zone, const uint8_t target=0) const
+        {
+            return !m_targets.empty() && m_targets[zone] == 0 ?
+                255 :
+                m_status[index(zone, target)];
+        }
+
+    private:
+
+        uint8_t m_zones;
+        uint8_t m_targetsPerZone;
+
+        VL53L5CX_Span<uint32_t> m_ambient;
+        VL53L5CX_Span<uint32_t> m_spads;
+        VL53L5CX_Span<uint8_t> m_targets;
+        VL53L5CX_Span<uint32_t> m_signal;
+        VL53L5CX_Span<uint16_t> m_sigma;
+        VL53L5CX_Span<int16_t> m_distance;
+        VL53L5CX_Span<uint8_t> m_reflectance;
+        VL53L5CX_Span<uint8_t> m_status;
+
+        uint16_t index(const uint8_t zone, const uint8_t target) const
+        {
+            // Out-of-range targets map past every block
+            return target < m_targetsPerZone ?
+                m_targetsPerZone * zone + target :
+                0xFFFF;
+        }
+
+        void clear(void)
+        {
+            m_zones = 0;
+            m_targetsPerZone = 0;
+            m_ambient = VL53L5CX_Span<uint32_t>();
+            m_spads = VL53L5CX_Span<uint32_t>();
+            m_targets = VL53L5CX_Span<uint8_t>();
+            m_signal = VL53L5CX_Span<uint32_t>();
+            m_sigma = VL53L5CX_Span<uint16_t>();
+            m_distance = VL53L5CX_Span<int16_t>();
+            m_reflectance = VL53L5CX_Span<uint8_t>();
+            m_status = VL53L5CX_Span<uint8_t>();
+        }
+
+        bool setBlock(const uint16_t idx, const uint8_t * payload,
+                const uint16_t size)
+        {
+            switch (idx) {
+                case VL53L5CX_AMBIENT_RATE_IDX:
+                    m_ambient = VL53L5CX_Span<uint32_t>(payload, size / 4);
+                    break;
+                case VL53L5CX_SPAD_COUNT_IDX:
+                    m_spads = VL53L5CX_Span<uint32_t>(payload, size / 4);
+                    break;
+                case VL53L5CX_NB_TARGET_DETECTED_IDX:
+                    m_targets = VL53L5CX_Span<uint8_t>(payload, size);
+                    break;
+                case VL53L5CX_SIGNAL_RATE_IDX:
+                    m_signal = VL53L5CX_Span<uint32_t>(payload, size / 4);
+                    break;
+                case VL53L5CX_RANGE_SIGMA_MM_IDX:
+                    m_sigma = VL53L5CX_Span<uint16_t>(payload, size / 2);
+                    break;
+                case VL53L5CX_DISTANCE_IDX:
+                    m_distance = VL53L5CX_Span<int16_t>(payload, size / 2);
+                    break;
+                case VL53L5CX_REFLECTANCE_EST_PC_IDX:
+                    m_reflectance = VL53L5CX_Span<uint8_t>(payload, size);
+                    break;
+                case VL53L5CX_TARGET_STATUS_IDX:
+                    m_status = VL53L5CX_Span<uint8_t>(payload, size);
+                    break;
+                case VL53L5CX_MOTION_DETEC_IDX:
+                    // Motion results are only decoded into
+                    // VL53L5CX_ResultsData
+                    break;
+                default:
+                    return false;
+            }
+
+            return true;
+        }
+
+}; // class VL53L5CX_FrameView
@@ -0,0 +1,119 @@
+/*
+   Latest VL53L5CX frame, published by one writer for any number of readers
+
+   The frame is guarded by a sequence lock: the writer never waits for the
+   readers, and a reader only copies the frame again if a new one was
+   published while it was copying
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#pragma once
+
+#include "st/vl53l5cx_api.h"
+
+#include <stdint.h>
+#include <string.h>
+
+// publish() must only be called from one thread at a time; read() and
+// tryRead() can be called from any number of threads.  A reader that can
+// interrupt the writer (an ISR, or a higher-priority task on the same core)
+// must use tryRead(), since read() would spin until the interrupted writer
+// is done.
+class VL53L5CX_LatestFrame {
+
+    public:
+
+        VL53L5CX_LatestFrame(void)
+            : m_sequence(0)
+        {
+        }
+
+        void publish(const VL53L5CX_ResultsData & frame)
+        {
+            const uint32_t sequence =
+                __atomic_load_n(&m_sequence, __ATOMIC_RELAXED) + 1;
+
+            // Odd while the frame is being written
+            __atomic_store_n(&m_sequence, sequence, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+
+            memcpy(&m_frame, &frame, sizeof(m_frame));
+
+            __atomic_store_n(&m_sequence, sequence + 1, __ATOMIC_RELEASE);
+        }
+
+        // Copies the latest frame, retrying until it is copied whole; returns
+        // false if no frame has been published yet.  The number of the frame
+        // (see published()) is returned in count if given.
+        bool read(VL53L5CX_ResultsData & frame, uint32_t * count=NULL) const
+        {
+            while (true) {
+
+                const uint32_t sequence =
+                    __atomic_load_n(&m_sequence, __ATOMIC_ACQUIRE);
+
+                if (sequence == 0) {
+                    return false;
+                }
+
+                if (copy(frame, sequence)) {
+                    if (count) {
+                        *count = sequence / 2;
+                    }
+                    return true;
+                }
+            }
+        }
+
+        // Single attempt of read(): returns false if no frame has been
+        // published yet, or if the writer was publishing one meanwhile
+        bool tryRead(VL53L5CX_ResultsData & frame, uint32_t * count=NULL) const
+        {
+            const uint32_t sequence =
+                __atomic_load_n(&m_sequence, __ATOMIC_ACQUIRE);
+
+            if (sequence == 0 || !copy(frame, sequence)) {
+                return false;
+            }
+
+            if (count) {
+                *count = sequence / 2;
+            }
+
+            return true;
+        }
+
+        // Frames published so far, counting the one being written; readers
+        // polling for new frames can compare it with the count of their last
+        // read
+        uint32_t published(void) const
+        {
+            return (__atomic_load_n(&m_sequence, __ATOMIC_ACQUIRE) + 1) / 2;
+        }
+
+    private:
+
+        // Even when the frame is stable, twice the number of frames published
+        uint32_t m_sequence;
+
+        VL53L5CX_ResultsData m_frame;
+
+        bool copy(VL53L5CX_ResultsData & frame, const uint32_t sequence) const
+        {
+            if (sequence & 1) {
+                return false;
+            }
+
+            memcpy(&frame, &m_frame, sizeof(frame));
+
+            // Keeps the copy before the second load of the sequence, which
+            // tells whether the writer started another frame meanwhile
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+            return __atomic_load_n(&m_sequence, __ATOMIC_RELAXED) == sequence;
+        }
+
+}; // class VL53L5CX_LatestFrame
@@ -0,0 +1,198 @@
+/*
+   VL53L5CX class library header, with resolution, targets per zone and
+   outputs fixed at compile time
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#pragma once
+
+#include "debugger.hpp"
+#include "vl53l5cx_static_results.hpp"
+
+#include "st/vl53l5cx_api.h"
+
+#include <stdint.h>
+
+// Unlike VL53L5CX, whose results are sized for 8x8 and any output, each
+// instantiation only stores the zones, targets and outputs it streams, and
+// decodes them with loops of constant length.  The settings cannot be
+// changed once running.
+template <
+    uint8_t RESOLUTION,
+    uint8_t TARGETS=1,
+    uint32_t OUTPUTS=VL53L5CX_OUTPUT_ALL>
+class VL53L5CX_Static :
+    public VL53L5CX_StaticResults<RESOLUTION, TARGETS, OUTPUTS> {
+
+    public:
+
+        typedef VL53L5CX_StaticLayout<RESOLUTION, TARGETS, OUTPUTS> Layout;
+
+        static constexpr uint8_t MAX_FREQUENCY_HZ =
+            RESOLUTION == VL53L5CX_RESOLUTION_4X4 ? 60 : 15;
+
+        void disable(void)
+        {
+            pinMode(m_lpnPin, OUTPUT);
+            digitalWrite(m_lpnPin, LOW);
+            delay(100);
+        }
+
+        void begin(const uint8_t address)
+        {
+            enable();
+            vl53l5cx_set_i2c_address(&m_config, address<<1);
+            m_config.platform.address = address;
+
+            begin();
+        }
+
+        void begin(void)
+        {
+            if (m_frequency < 1 || m_frequency > MAX_FREQUENCY_HZ) {
+                Debugger::reportForever(
+                        "VL53L5CX frequency must be 1 to %d Hz",
+                        MAX_FREQUENCY_HZ);
+            }
+
+            // Reset
+            disable();
+            enable();
+
+            // Check if there is a VL53L5CX sensor connected
+            uint8_t isAlive = 0;
+
+            checkStatus(vl53l5cx_is_alive(&m_config, &isAlive),
+                    "VL53L5CX could not write to device");
+
+            if (!isAlive) {
+                Debugger::reportForever("VL53L5CX not detected at address 0x%0X",
+                        m_config.platform.address);
+            }
+
+            checkStatus(vl53l5cx_init(&m_config), "VL53L5CX ULD Loading failed");
+
+            checkStatus(vl53l5cx_set_outputs(&m_config, OUTPUTS),
+                    "vl53l5cx_set_outputs failed, status %u\n");
+
+            checkStatus(vl53l5cx_set_nb_target_per_zone(&m_config, TARGETS),
+                    "vl53l5cx_set_nb_target_per_zone failed, status %u\n");
+
+            checkStatus(vl53l5cx_set_resolution(&m_config, RESOLUTION),
+                    "vl53l5cx_set_resolution failed, status %u\n");
+
+            if (m_integralTime > 0) {
+
+                checkStatus(vl53l5cx_set_ranging_mode(&m_config,
+                            VL53L5CX_RANGING_MODE_AUTONOMOUS),
+                        "vl53l5cx_set_ranging_mode failed, status %u\n");
+
+                checkStatus(vl53l5cx_set_integration_time_ms(&m_config,
+                            m_integralTime),
+                        "vl53l5cx_set_integration_time_ms failed, status %u\n");
+            }
+            else {
+                checkStatus(vl53l5cx_set_ranging_mode(&m_config,
+                            VL53L5CX_RANGING_MODE_CONTINUOUS),
+                        "vl53l5cx_set_ranging_mode failed, status %u\n");
+            }
+
+            checkStatus(vl53l5cx_set_ranging_frequency_hz(&m_config,
+                        m_frequency),
+                    "vl53l5cx_set_ranging_frequency_hz failed, status %u\n");
+
+            checkStatus(vl53l5cx_start_ranging(&m_config),
+                    "start error = 0x%02X\n");
+
+            // Outputs disabled by a VL53L5CX_DISABLE_... macro are not
+            // streamed, so the frame would not match the layout
+            if (m_config.data_read_size != Layout::DATA_READ_SIZE) {
+                Debugger::reportForever(
+                        "VL53L5CX streams %d bytes per frame instead of %d",
+                        (int)m_config.data_read_size,
+                        (int)Layout::DATA_READ_SIZE);
+            }
+
+            uint8_t isReady = 0;
+
+            // Clear the interrupt
+            checkStatus(vl53l5cx_check_data_ready(&m_config, &isReady),
+                    "check data ready: %u\n");
+        }
+
+        // Uses this scratch buffer instead of the one shared by default; must
+        // be called before begin()
+        void setScratch(VL53L5CX_Scratch & scratch)
+        {
+            vl53l5cx_set_scratch(&m_config, &scratch);
+        }
+
+        bool dataIsReady(void)
+        {
+            uint8_t isReady = 0;
+
+            uint8_t error = vl53l5cx_check_data_ready(&m_config, &isReady);
+
+            if (error !=0) {
+                Debugger::printf("ready error = 0x%02X\n", error);
+            }
+
+            return isReady != 0;
+        }
+
+        // Returns false if the frame could not be read or decoded, leaving
+        // the previous results
+        bool readData(void)
+        {
+            return vl53l5cx_get_raw_data(&m_config, NULL) ==
+                VL53L5CX_STATUS_OK &&
+                this->decode(m_config.temp_buffer);
+        }
+
+    protected:
+
+        VL53L5CX_Static(
+                void * i2c_device,
+                const uint8_t lpnPin,
+                const uint8_t integralTime,
+                const uint8_t freq,
+                const uint8_t address=0x29)
+            : m_config()
+        {
+            vl53l5cx_config_init(&m_config);
+            vl53l5cx_set_calibration(&m_config, &m_calibration);
+            m_lpnPin = lpnPin;
+            m_config.platform.address = address;
+            m_config.platform.device = i2c_device;
+            m_integralTime = integralTime;
+            m_frequency = freq;
+        }
+
+    private:
+
+        VL53L5CX_Configuration m_config;
+
+        // Offsets, only used when starting and when changing resolution;
+        // the sensor keeps the default xtalk of the driver
+        VL53L5CX_Calibration m_calibration;
+
+        uint8_t m_lpnPin;
+        uint8_t m_frequency;
+        uint8_t m_integralTime;
+
+        void enable(void)
+        {
+            pinMode(m_lpnPin, OUTPUT);
+            digitalWrite(m_lpnPin, HIGH);
+            delay(100);
+        }
+
+        static void checkStatus(const uint8_t error, const char * fmt)
+        {
+            Debugger::checkStatus(error, fmt);
+        }
+
+}; // class VL53L5CX_Static
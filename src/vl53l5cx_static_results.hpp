@@ -0,0 +1,396 @@
+/*
+   VL53L5CX results sized at compile time
+
+   Frame layout, storage and decoding for a resolution, a number of targets
+   per zone and a set of outputs known at compile time
+
+   Copyright (c) 2021 Simon D. Levy
+
+   MIT License
+ */
+
+#pragma once
+
+#include "st/vl53l5cx_api.h"
+
+#include <stdint.h>
+#include <string.h>
+
+// Frame layout matching the output list programmed by
+// vl53l5cx_start_ranging()
+template <uint8_t RESOLUTION, uint8_t TARGETS, uint32_t OUTPUTS>
+class VL53L5CX_StaticLayout {
+
+    static_assert(RESOLUTION == VL53L5CX_RESOLUTION_4X4 ||
+            RESOLUTION == VL53L5CX_RESOLUTION_8X8,
+            "VL53L5CX resolution must be 16 (4x4) or 64 (8x8) zones");
+
+    static_assert(TARGETS >= 1 && TARGETS <= VL53L5CX_NB_TARGET_PER_ZONE,
+            "VL53L5CX targets per zone must be 1 to "
+            "VL53L5CX_NB_TARGET_PER_ZONE");
+
+    static_assert((OUTPUTS & ~VL53L5CX_OUTPUT_ALL) == 0,
+            "VL53L5CX outputs must be VL53L5CX_OUTPUT_... flags");
+
+    public:
+
+        static constexpr uint16_t ZONES = RESOLUTION;
+
+        // Entries of the per-target blocks
+        static constexpr uint16_t ENTRIES = RESOLUTION * TARGETS;
+
+        static constexpr bool has(const uint32_t output)
+        {
+            return (OUTPUTS & output) != 0;
+        }
+
+        static constexpr uint16_t payloadSize(const uint32_t output)
+        {
+            return
+                output == VL53L5CX_OUTPUT_AMBIENT_PER_SPAD ? 4 * ZONES :
+                output == VL53L5CX_OUTPUT_NB_SPADS_ENABLED ? 4 * ZONES :
+                output == VL53L5CX_OUTPUT_NB_TARGET_DETECTED ? ZONES :
+                output == VL53L5CX_OUTPUT_SIGNAL_PER_SPAD ? 4 * ENTRIES :
+                output == VL53L5CX_OUTPUT_RANGE_SIGMA_MM ? 2 * ENTRIES :
+                output == VL53L5CX_OUTPUT_DISTANCE_MM ? 2 * ENTRIES :
+                output == VL53L5CX_OUTPUT_REFLECTANCE_PERCENT ? ENTRIES :
+                output == VL53L5CX_OUTPUT_TARGET_STATUS ? ENTRIES :
+                output == VL53L5CX_OUTPUT_MOTION_INDICATOR ? 140 :
+                0;
+        }
+
+        static constexpr uint16_t idx(const uint32_t output)
+        {
+            return
+                output == VL53L5CX_OUTPUT_AMBIENT_PER_SPAD ?
+                VL53L5CX_AMBIENT_RATE_IDX :
+                output == VL53L5CX_OUTPUT_NB_SPADS_ENABLED ?
+                VL53L5CX_SPAD_COUNT_IDX :
+                output == VL53L5CX_OUTPUT_NB_TARGET_DETECTED ?
+                VL53L5CX_NB_TARGET_DETECTED_IDX :
+                output == VL53L5CX_OUTPUT_SIGNAL_PER_SPAD ?
+                VL53L5CX_SIGNAL_RATE_IDX :
+                output == VL53L5CX_OUTPUT_RANGE_SIGMA_MM ?
+                VL53L5CX_RANGE_SIGMA_MM_IDX :
+                output == VL53L5CX_OUTPUT_DISTANCE_MM ?
+                VL53L5CX_DISTANCE_IDX :
+                output == VL53L5CX_OUTPUT_REFLECTANCE_PERCENT ?
+                VL53L5CX_REFLECTANCE_EST_PC_IDX :
+                output == VL53L5CX_OUTPUT_TARGET_STATUS ?
+                VL53L5CX_TARGET_STATUS_IDX :
+                VL53L5CX_MOTION_DETEC_IDX;
+        }
+
+        // Values decoded from an output, 0 if not streamed
+        static constexpr uint16_t count(const uint32_t output,
+                const uint16_t n)
+        {
+            return has(output) ? n : 0;
+        }
+
+        // Block with its header, 0 if not streamed
+        static constexpr uint16_t blockSize(const uint32_t output)
+        {
+            return has(output) ? 4 + payloadSize(output) : 0;
+        }
+
+        // Optional blocks streamed before an output; they follow the order
+        // of the output flags
+        static constexpr uint16_t before(const uint32_t output)
+        {
+            return output <= VL53L5CX_OUTPUT_AMBIENT_PER_SPAD ? 0 :
+                before(output >> 1) + blockSize(output >> 1);
+        }
+
+        // Start, metadata and common data blocks, with their headers
+        static constexpr uint16_t MANDATORY_SIZE = 4 + (4 + 12) + (4 + 4);
+
+        // Payload of an output in the frame, after 12 bytes of headers
+        static constexpr uint16_t offset(const uint32_t output)
+        {
+            return 16 + MANDATORY_SIZE + before(output);
+        }
+
+        // Bytes read per frame, including the 20 bytes of headers and footer
+        static constexpr uint16_t DATA_READ_SIZE = MANDATORY_SIZE +
+            before(VL53L5CX_OUTPUT_MOTION_INDICATOR << 1) + 20;
+
+}; // class VL53L5CX_StaticLayout
+
+// N values, or nothing for an output that is not streamed
+template <typename T, uint16_t N>
+class VL53L5CX_StaticArray {
+
+    public:
+
+        T * data(void)
+        {
+            return m_values;
+        }
+
+        const T * data(void) const
+        {
+            return m_values;
+        }
+
+    private:
+
+        T m_values[N];
+
+}; // class VL53L5CX_StaticArray
+
+template <typename T>
+class VL53L5CX_StaticArray<T, 0> {
+
+    public:
+
+        T * data(void)
+        {
+            return NULL;
+        }
+
+        const T * data(void) const
+        {
+            return NULL;
+        }
+
+}; // class VL53L5CX_StaticArray
+
+// Same layout as the motion_indicator of VL53L5CX_ResultsData
+typedef struct {
+
+    uint32_t global_indicator_1;
+    uint32_t global_indicator_2;
+    uint8_t status;
+    uint8_t nb_of_detected_aggregates;
+    uint8_t nb_of_aggregates;
+    uint8_t spare;
+    uint32_t motion[32];
+
+} VL53L5CX_StaticMotion;
+
+template <uint8_t RESOLUTION, uint8_t TARGETS, uint32_t OUTPUTS>
+class VL53L5CX_StaticResults {
+
+    public:
+
+        typedef VL53L5CX_StaticLayout<RESOLUTION, TARGETS, OUTPUTS> Layout;
+
+        // Frames are read into the driver's temporary buffer, sized by
+        // VL53L5CX_MAX_RESOLUTION, VL53L5CX_NB_TARGET_PER_ZONE and the
+        // VL53L5CX_DISABLE_... macros
+        static_assert(Layout::DATA_READ_SIZE <= VL53L5CX_TEMPORARY_BUFFER_SIZE,
+                "VL53L5CX frame does not fit the temporary buffer");
+
+        // Decodes a frame of Layout::DATA_READ_SIZE bytes in firmware byte
+        // order, converting values as vl53l5cx_get_ranging_data() does.
+        // Returns false, leaving the results unchanged, if the blocks do not
+        // match the layout.
+        bool decode(const uint8_t * frame)
+        {
+            if (!(hasHeader<VL53L5CX_OUTPUT_AMBIENT_PER_SPAD>(frame) &&
+                        hasHeader<VL53L5CX_OUTPUT_NB_SPADS_ENABLED>(frame) &&
+                        hasHeader<VL53L5CX_OUTPUT_NB_TARGET_DETECTED>(frame) &&
+                        hasHeader<VL53L5CX_OUTPUT_SIGNAL_PER_SPAD>(frame) &&
+                        hasHeader<VL53L5CX_OUTPUT_RANGE_SIGMA_MM>(frame) &&
+                        hasHeader<VL53L5CX_OUTPUT_DISTANCE_MM>(frame) &&
+                        hasHeader<VL53L5CX_OUTPUT_REFLECTANCE_PERCENT>(frame) &&
+                        hasHeader<VL53L5CX_OUTPUT_TARGET_STATUS>(frame) &&
+                        hasHeader<VL53L5CX_OUTPUT_MOTION_INDICATOR>(frame))) {
+                return false;
+            }
+
+            copy(m_ambient, payload<VL53L5CX_OUTPUT_AMBIENT_PER_SPAD>(frame));
+            for (uint16_t i=0; i<AMBIENT; ++i) {
+                m_ambient.data()[i] /= 2048;
+            }
+
+            copy(m_spads, payload<VL53L5CX_OUTPUT_NB_SPADS_ENABLED>(frame));
+
+            copy(m_targets, payload<VL53L5CX_OUTPUT_NB_TARGET_DETECTED>(frame));
+
+            copy(m_signal, payload<VL53L5CX_OUTPUT_SIGNAL_PER_SPAD>(frame));
+            for (uint16_t i=0; i<SIGNAL; ++i) {
+                m_signal.data()[i] /= 2048;
+            }
+
+            copy(m_sigma, payload<VL53L5CX_OUTPUT_RANGE_SIGMA_MM>(frame));
+            for (uint16_t i=0; i<SIGMA; ++i) {
+                m_sigma.data()[i] /= 128;
+            }
+
+            copy(m_distance, payload<VL53L5CX_OUTPUT_DISTANCE_MM>(frame));
+            for (uint16_t i=0; i<DISTANCE; ++i) {
+                const int16_t distance = m_distance.data()[i];
+                m_distance.data()[i] = distance < 0 ? 0 : distance / 4;
+            }
+
+            copy(m_reflectance,
+                    payload<VL53L5CX_OUTPUT_REFLECTANCE_PERCENT>(frame));
+
+            copy(m_status, payload<VL53L5CX_OUTPUT_TARGET_STATUS>(frame));
+            if (TARGETS_DETECTED > 0) {
+                for (uint16_t i=0; i<STATUS; ++i) {
+                    const uint8_t status = m_status.data()[i];
+                    m_status.data()[i] =
+                        m_targets.data()[i / TARGETS] == 0 ? 255 : status;
+                }
+            }
+
+            copy(m_motion, payload<VL53L5CX_OUTPUT_MOTION_INDICATOR>(frame));
+            for (uint16_t i=0; i<MOTION; ++i) {
+                for (uint8_t k=0; k<32; ++k) {
+                    m_motion.data()[i].motion[k] /= 65535;
+                }
+            }
+
+            return true;
+        }
+
+        uint8_t getPixelCount(void) const
+        {
+            return RESOLUTION;
+        }
+
+        uint8_t getTargetsPerZone(void) const
+        {
+            return TARGETS;
+        }
+
+        uint32_t getAmbientPerSpad(const uint8_t pixel) const
+        {
+            static_assert(AMBIENT > 0, "VL53L5CX ambient is not streamed");
+            return m_ambient.data()[pixel];
+        }
+
+        uint32_t getSpadsEnabled(const uint8_t pixel) const
+        {
+            static_assert(SPADS > 0, "VL53L5CX SPAD count is not streamed");
+            return m_spads.data()[pixel];
+        }
+
+        uint8_t getTargetDetectedCount(const uint8_t pixel) const
+        {
+            static_assert(TARGETS_DETECTED > 0,
+                    "VL53L5CX target count is not streamed");
+            return m_targets.data()[pixel];
+        }
+
+        uint32_t getSignalPerSpad(const uint8_t pixel,
+                const uint8_t target=0) const
+        {
+            static_assert(SIGNAL > 0, "VL53L5CX signal is not streamed");
+            return m_signal.data()[TARGETS * pixel + target];
+        }
+
+        uint16_t getRangeSigmaMm(const uint8_t pixel,
+                const uint8_t target=0) const
+        {
+            static_assert(SIGMA > 0, "VL53L5CX range sigma is not streamed");
+            return m_sigma.data()[TARGETS * pixel + target];
+        }
+
+        int16_t getDistanceMm(const uint8_t pixel,
+                const uint8_t target=0) const
+        {
+            static_assert(DISTANCE > 0, "VL53L5CX distance is not streamed");
+            return m_distance.data()[TARGETS * pixel + target];
+        }
+
+        uint8_t getReflectance(const uint8_t pixel,
+                const uint8_t target=0) const
+        {
+            static_assert(REFLECTANCE > 0,
+                    "VL53L5CX reflectance is not streamed");
+            return m_reflectance.data()[TARGETS * pixel + target];
+        }
+
+        uint8_t getTargetStatus(const uint8_t pixel,
+                const uint8_t target=0) const
+        {
+            static_assert(STATUS > 0,
+                    "VL53L5CX target status is not streamed");
+            return m_status.data()[TARGETS * pixel + target];
+        }
+
+        const VL53L5CX_StaticMotion & getMotionIndicator(void) const
+        {
+            static_assert(MOTION > 0,
+                    "VL53L5CX motion indicator is not streamed");
+            return m_motion.data()[0];
+        }
+
+    private:
+
+        static constexpr uint16_t AMBIENT = Layout::count(
+                VL53L5CX_OUTPUT_AMBIENT_PER_SPAD, Layout::ZONES);
+        static constexpr uint16_t SPADS = Layout::count(
+                VL53L5CX_OUTPUT_NB_SPADS_ENABLED, Layout::ZONES);
+        static constexpr uint16_t TARGETS_DETECTED = Layout::count(
+                VL53L5CX_OUTPUT_NB_TARGET_DETECTED, Layout::ZONES);
+        static constexpr uint16_t SIGNAL = Layout::count(
+                VL53L5CX_OUTPUT_SIGNAL_PER_SPAD, Layout::ENTRIES);
+        static constexpr uint16_t SIGMA = Layout::count(
+                VL53L5CX_OUTPUT_RANGE_SIGMA_MM, Layout::ENTRIES);
+        static constexpr uint16_t DISTANCE = Layout::count(
+                VL53L5CX_OUTPUT_DISTANCE_MM, Layout::ENTRIES);
+        static constexpr uint16_t REFLECTANCE = Layout::count(
+                VL53L5CX_OUTPUT_REFLECTANCE_PERCENT, Layout::ENTRIES);
+        static constexpr uint16_t STATUS = Layout::count(
+                VL53L5CX_OUTPUT_TARGET_STATUS, Layout::ENTRIES);
+        static constexpr uint16_t MOTION = Layout::count(
+                VL53L5CX_OUTPUT_MOTION_INDICATOR, 1);
+
+        VL53L5CX_StaticArray<uint32_t, AMBIENT> m_ambient;
+        VL53L5CX_StaticArray<uint32_t, SPADS> m_spads;
+        VL53L5CX_StaticArray<uint8_t, TARGETS_DETECTED> m_targets;
+        VL53L5CX_StaticArray<uint32_t, SIGNAL> m_signal;
+        VL53L5CX_StaticArray<uint16_t, SIGMA> m_sigma;
+        VL53L5CX_StaticArray<int16_t, DISTANCE> m_distance;
+        VL53L5CX_StaticArray<uint8_t, REFLECTANCE> m_reflectance;
+        VL53L5CX_StaticArray<uint8_t, STATUS> m_status;
+        VL53L5CX_StaticArray<VL53L5CX_StaticMotion, MOTION> m_motion;
+
+        // Offsets are constants, whatever the optimization level
+        template <uint32_t BLOCK>
+        static const uint8_t * payload(const uint8_t * frame)
+        {
+            static constexpr uint16_t OFFSET = Layout::offset(BLOCK);
+            return &frame[OFFSET];
+        }
+
+        template <uint32_t BLOCK>
+        static bool hasHeader(const uint8_t * frame)
+        {
+            if (!Layout::has(BLOCK)) {
+                return true;
+            }
+
+            static constexpr uint16_t IDX = Layout::idx(BLOCK);
+
+            union Block_header bh;
+            bh.bytes = word(payload<BLOCK>(frame) - 4);
+
+            return bh.idx == IDX;
+        }
+
+        // Firmware words are big-endian
+        static uint32_t word(const uint8_t * p)
+        {
+            return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 |
+                (uint32_t)p[2] << 8 | p[3];
+        }
+
+        // Copies a block, then swaps its words in place: as blocks are
+        // whole words, values end up in host order
+        template <typename T, uint16_t N>
+        static void copy(VL53L5CX_StaticArray<T, N> & dst,
+                const uint8_t * src)
+        {
+            if (N > 0) {
+                memcpy(dst.data(), src, N * sizeof(T));
+                vl53l5cx_swap_buffer((uint8_t *)dst.data(), N * sizeof(T));
+            }
+        }
+
+}; // class VL53L5CX_StaticResults